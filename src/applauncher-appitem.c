@@ -36,6 +36,7 @@ struct _ApplauncherAppItemPrivate
 	GtkWidget *tooltip;
 
 	int icon_size;
+	ApplauncherIconCache *icon_cache; /* 애플릿 소유 */
 
 	gchar *path;
 };
@@ -116,12 +117,14 @@ applauncher_appitem_class_init (ApplauncherAppItemClass *klass)
 }
 
 ApplauncherAppItem *
-applauncher_appitem_new (int size)
+applauncher_appitem_new (int                   size,
+                         ApplauncherIconCache *icon_cache)
 {
 	ApplauncherAppItem *item;
 
 	item = g_object_new (APPLAUNCHER_TYPE_APPITEM, NULL);
 	item->priv->icon_size = size;
+	item->priv->icon_cache = icon_cache;
 	return item;
 }
 
@@ -134,11 +137,21 @@ applauncher_appitem_change_app (ApplauncherAppItem *item,
 {
 	glong size;
 	gchar buf[1024] = {0,};
+	cairo_surface_t *surface = NULL;
 
 	ApplauncherAppItemPrivate *priv = item->priv;
 
+	/* 페이지를 넘길 때마다 테마를 찾고 이미지를 디코딩하지 않도록 캐시된 서피스를 쓴다. */
+	if (icon && priv->icon_cache) {
+		surface = applauncher_icon_cache_lookup (priv->icon_cache, icon, priv->icon_size,
+                                                 gtk_widget_get_scale_factor (GTK_WIDGET (item)));
+	}
+
 	// Icon
-	if (icon) {
+	if (surface) {
+		gtk_image_set_from_surface (GTK_IMAGE (priv->icon), surface);
+		cairo_surface_destroy (surface);
+	} else if (icon) {
 		gtk_image_set_from_gicon (GTK_IMAGE (priv->icon), icon, GTK_ICON_SIZE_BUTTON);
 		gtk_image_set_pixel_size (GTK_IMAGE (priv->icon), priv->icon_size);
 	} else {
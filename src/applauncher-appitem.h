@@ -23,6 +23,8 @@
 #include <glib.h>
 #include <gtk/gtk.h>
 
+#include "applauncher-icon-cache.h"
+
 G_BEGIN_DECLS
 
 #define APPLAUNCHER_TYPE_APPITEM            (applauncher_appitem_get_type ())
@@ -51,7 +53,8 @@ struct _ApplauncherAppItem
 
 GType               applauncher_appitem_get_type   (void) G_GNUC_CONST;
 
-ApplauncherAppItem *applauncher_appitem_new        (int size);
+ApplauncherAppItem *applauncher_appitem_new        (int                   size,
+                                                    ApplauncherIconCache *icon_cache);
 
 void                applauncher_appitem_change_app (ApplauncherAppItem *item,
                                                     GIcon              *icon,
@@ -46,20 +46,35 @@
 
 #include <libgnome-panel/gp-applet.h>
 
-#include "panel-glib.h"
+#include "applauncher-catalog.h"
 #include "applauncher-window.h"
 #include "applauncher-applet.h"
 
 
 #define TRAY_ICON_SIZE             (24)
 #define XFCE_SPAWN_STARTUP_TIMEOUT (30)
+#define SEARCH_CACHE_SIZE          (64)
+#define ICON_CACHE_SIZE            (16) /* MB */
+
+#define APPLAUNCHER_SCHEMA         "apps.gooroom-applauncher-applet"
+#define ICON_CACHE_SIZE_KEY        "icon-cache-size"
 
 
 struct _GooroomApplauncherAppletPrivate
 {
-	GtkWidget         *button;
+	GtkWidget          *button;
+
+	ApplauncherWindow  *popup_window;
+
+	ApplauncherCatalog *catalog;
+
+	ApplauncherSearchCache *search_cache;
 
-	ApplauncherWindow *popup_window;
+	ApplauncherHistory *history;
+
+	ApplauncherIconCache *icon_cache;
+
+	GSettings          *settings;
 };
 
 typedef struct
@@ -87,6 +102,19 @@ destroy_popup_window (GooroomApplauncherApplet *applet)
 	}
 }
 
+static void
+hide_popup_window (GooroomApplauncherApplet *applet)
+{
+	ApplauncherWindow *window = applet->priv->popup_window;
+
+	if (window) {
+		gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (applet->priv->button), FALSE);
+		gtk_widget_hide (GTK_WIDGET (window));
+		/* 다음 팝업이 바로 표시될 수 있도록 숨길 때 상태를 초기화한다. */
+		applauncher_window_reset (window);
+	}
+}
+
 static void
 show_error_dialog (GtkWindow *parent,
                    GdkScreen *screen,
@@ -673,7 +701,10 @@ launch_desktop_cb (ApplauncherWindow *window, const gchar *desktop_id, gpointer
 {
 	GooroomApplauncherApplet *applet = GOOROOM_APPLAUNCHER_APPLET (data);
 
-	destroy_popup_window (applet);
+	/* 창을 숨기면서 전체 프로그램의 자주 쓰는 항목이 다시 구성되므로 먼저 기록한다. */
+	applauncher_history_record (applet->priv->history, desktop_id);
+
+	hide_popup_window (applet);
 
 	GdkScreen *screen = gtk_widget_get_screen (GTK_WIDGET (applet->priv->button));
 	if (!launch_desktop_id (desktop_id, screen)) {
@@ -686,7 +717,7 @@ popup_window_closed_cb (ApplauncherWindow *window,
                         gint               reason,
                         gpointer           data)
 {
-	destroy_popup_window (GOOROOM_APPLAUNCHER_APPLET (data));
+	hide_popup_window (GOOROOM_APPLAUNCHER_APPLET (data));
 }
 
 static void
@@ -698,6 +729,17 @@ popup_window_realize_cb (ApplauncherWindow *window,
 	set_popup_window_position (applet);
 }
 
+static void
+popup_window_reloaded_cb (ApplauncherWindow *window,
+                          gpointer           data)
+{
+	GooroomApplauncherApplet *applet = GOOROOM_APPLAUNCHER_APPLET (data);
+
+	/* 카탈로그를 읽은 뒤 윈도우 크기가 바뀌므로 위치를 다시 계산한다. */
+	if (gtk_widget_get_realized (GTK_WIDGET (window)))
+		set_popup_window_position (applet);
+}
+
 static void
 applauncher_window_popup (GooroomApplauncherApplet *applet)
 {
@@ -706,16 +748,28 @@ applauncher_window_popup (GooroomApplauncherApplet *applet)
 
 	GooroomApplauncherAppletPrivate *priv = applet->priv;
 
-	window = priv->popup_window = applauncher_window_new (GTK_WIDGET (applet));
+	get_workarea (applet, &workarea);
+
+	if (priv->popup_window) {
+		/* 미리 만들어 둔 윈도우를 다시 보여준다. */
+		window = priv->popup_window;
+		applauncher_window_set_workarea (window, &workarea);
+		set_popup_window_position (applet);
+		gtk_widget_show (GTK_WIDGET (window));
+		gtk_window_present_with_time (GTK_WINDOW (window), gtk_get_current_event_time ());
+		return;
+	}
+
+	window = priv->popup_window = applauncher_window_new (GTK_WIDGET (applet), priv->catalog, priv->search_cache, priv->history, priv->icon_cache);
 	gtk_window_set_screen (GTK_WINDOW (window),
                            gtk_widget_get_screen (GTK_WIDGET (applet)));
 
-	get_workarea (applet, &workarea);
 	applauncher_window_set_workarea (window, &workarea);
 
 	g_signal_connect (G_OBJECT (window), "realize", G_CALLBACK (popup_window_realize_cb), applet);
 	g_signal_connect (G_OBJECT (window), "closed", G_CALLBACK (popup_window_closed_cb), applet);
 	g_signal_connect (G_OBJECT (window), "launch-desktop", G_CALLBACK (launch_desktop_cb), applet);
+	g_signal_connect (G_OBJECT (window), "reloaded", G_CALLBACK (popup_window_reloaded_cb), applet);
 
 	gtk_widget_show_all (GTK_WIDGET (window));
 
@@ -791,6 +845,50 @@ gooroom_applauncher_applet_size_allocate (GtkWidget     *widget,
 		GTK_WIDGET_CLASS (gooroom_applauncher_applet_parent_class)->size_allocate (widget, allocation);
 }
 
+static gsize
+get_icon_cache_size (GooroomApplauncherApplet *applet)
+{
+	gint size = ICON_CACHE_SIZE;
+
+	if (applet->priv->settings)
+		size = g_settings_get_int (applet->priv->settings, ICON_CACHE_SIZE_KEY);
+
+	return (gsize)MAX (size, 1) * 1024 * 1024;
+}
+
+static void
+settings_icon_cache_size_changed_cb (GSettings   *settings,
+                                     const gchar *key,
+                                     gpointer     data)
+{
+	GooroomApplauncherApplet *applet = GOOROOM_APPLAUNCHER_APPLET (data);
+
+	applauncher_icon_cache_set_max_size (applet->priv->icon_cache, get_icon_cache_size (applet));
+}
+
+static void
+gooroom_applauncher_applet_dispose (GObject *object)
+{
+	GooroomApplauncherApplet *applet = GOOROOM_APPLAUNCHER_APPLET (object);
+
+	if (applet->priv->popup_window) {
+		gtk_widget_destroy (GTK_WIDGET (applet->priv->popup_window));
+		applet->priv->popup_window = NULL;
+	}
+
+	g_clear_object (&applet->priv->catalog);
+	g_clear_pointer (&applet->priv->search_cache, applauncher_search_cache_free);
+	g_clear_pointer (&applet->priv->history, applauncher_history_free);
+
+	if (applet->priv->settings) {
+		g_signal_handlers_disconnect_by_data (applet->priv->settings, applet);
+		g_clear_object (&applet->priv->settings);
+	}
+	g_clear_pointer (&applet->priv->icon_cache, applauncher_icon_cache_free);
+
+	G_OBJECT_CLASS (gooroom_applauncher_applet_parent_class)->dispose (object);
+}
+
 static void
 gooroom_applauncher_applet_finalize (GObject *object)
 {
@@ -820,11 +918,45 @@ gooroom_applauncher_applet_init (GooroomApplauncherApplet *applet)
 {
 	GtkWidget *icon;
 	GdkDisplay *display;
+	gchar *history_path;
+	GSettingsSchemaSource *source;
+	GSettingsSchema *schema = NULL;
 	GooroomApplauncherAppletPrivate *priv;
 
 	priv = applet->priv = gooroom_applauncher_applet_get_instance_private (applet);
 
 	priv->popup_window = NULL;
+
+	/* 처음 팝업을 열기 전에 카탈로그를 미리 읽어 두고, 이후 변경은 카탈로그가 반영한다. */
+	priv->catalog = applauncher_catalog_new ();
+	applauncher_catalog_reload (priv->catalog);
+
+	/* 팝업을 다시 만들어도 자주 쓰는 검색어의 결과는 그대로 쓴다. */
+	priv->search_cache = applauncher_search_cache_new (SEARCH_CACHE_SIZE);
+
+	history_path = applauncher_history_get_path ();
+	priv->history = applauncher_history_new (history_path);
+	g_free (history_path);
+
+	/* 스키마가 설치되지 않은 경우에도 동작하도록 먼저 확인한다. */
+	priv->settings = NULL;
+	source = g_settings_schema_source_get_default ();
+	if (source)
+		schema = g_settings_schema_source_lookup (source, APPLAUNCHER_SCHEMA, TRUE);
+
+	if (schema) {
+		if (g_settings_schema_has_key (schema, ICON_CACHE_SIZE_KEY))
+			priv->settings = g_settings_new_full (schema, NULL, NULL);
+		g_settings_schema_unref (schema);
+	}
+
+	/* 디코딩한 아이콘을 팝업 사이에서 공유한다. */
+	priv->icon_cache = applauncher_icon_cache_new (gtk_icon_theme_get_default (),
+                                                   get_icon_cache_size (applet));
+	if (priv->settings) {
+		g_signal_connect (priv->settings, "changed::" ICON_CACHE_SIZE_KEY,
+                          G_CALLBACK (settings_icon_cache_size_changed_cb), applet);
+	}
 //	keybinder_init ();
 
 //	keybinder_bind ("Super_L", window_key_pressed_cb, applet);
@@ -866,6 +998,7 @@ gooroom_applauncher_applet_class_init (GooroomApplauncherAppletClass *class)
 	widget_class = GTK_WIDGET_CLASS (class);
 
 	object_class->constructed = gooroom_applauncher_applet_constructed;
+	object_class->dispose = gooroom_applauncher_applet_dispose;
 	object_class->finalize = gooroom_applauncher_applet_finalize;
 
 	widget_class->realize       = gooroom_applauncher_applet_realize;
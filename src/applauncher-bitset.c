@@ -0,0 +1,191 @@
+/*
+ *  Copyright (C) 2018-2021 Gooroom <gooroom@gooroom.kr>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string.h>
+
+#include "applauncher-bitset.h"
+
+
+#define WORD_BITS      (sizeof (gulong) * 8)
+#define N_WORDS(bits)  (((bits) + WORD_BITS - 1) / WORD_BITS)
+
+struct _ApplauncherBitset
+{
+	guint   n_bits;
+	guint   n_words;
+	gulong *words;
+};
+
+
+ApplauncherBitset *
+applauncher_bitset_new (guint n_bits)
+{
+	ApplauncherBitset *bitset;
+
+	bitset = g_slice_new0 (ApplauncherBitset);
+	applauncher_bitset_resize (bitset, n_bits);
+
+	return bitset;
+}
+
+void
+applauncher_bitset_free (ApplauncherBitset *bitset)
+{
+	if (!bitset)
+		return;
+
+	g_free (bitset->words);
+	g_slice_free (ApplauncherBitset, bitset);
+}
+
+guint
+applauncher_bitset_get_size (const ApplauncherBitset *bitset)
+{
+	g_return_val_if_fail (bitset != NULL, 0);
+
+	return bitset->n_bits;
+}
+
+/* 크기를 바꾸고 모든 비트를 지운다. */
+void
+applauncher_bitset_resize (ApplauncherBitset *bitset,
+                           guint              n_bits)
+{
+	guint n_words;
+
+	g_return_if_fail (bitset != NULL);
+
+	n_words = N_WORDS (n_bits);
+	if (n_words != bitset->n_words) {
+		g_free (bitset->words);
+		bitset->words = n_words ? g_new0 (gulong, n_words) : NULL;
+		bitset->n_words = n_words;
+	} else {
+		applauncher_bitset_clear (bitset);
+	}
+
+	bitset->n_bits = n_bits;
+}
+
+void
+applauncher_bitset_clear (ApplauncherBitset *bitset)
+{
+	g_return_if_fail (bitset != NULL);
+
+	if (bitset->n_words)
+		memset (bitset->words, 0, bitset->n_words * sizeof (gulong));
+}
+
+void
+applauncher_bitset_add (ApplauncherBitset *bitset,
+                        guint              bit)
+{
+	g_return_if_fail (bitset != NULL);
+	g_return_if_fail (bit < bitset->n_bits);
+
+	bitset->words[bit / WORD_BITS] |= (1UL << (bit % WORD_BITS));
+}
+
+void
+applauncher_bitset_remove (ApplauncherBitset *bitset,
+                           guint              bit)
+{
+	g_return_if_fail (bitset != NULL);
+	g_return_if_fail (bit < bitset->n_bits);
+
+	bitset->words[bit / WORD_BITS] &= ~(1UL << (bit % WORD_BITS));
+}
+
+gboolean
+applauncher_bitset_contains (const ApplauncherBitset *bitset,
+                             guint                    bit)
+{
+	g_return_val_if_fail (bitset != NULL, FALSE);
+
+	if (bit >= bitset->n_bits)
+		return FALSE;
+
+	return (bitset->words[bit / WORD_BITS] & (1UL << (bit % WORD_BITS))) != 0;
+}
+
+void
+applauncher_bitset_copy (ApplauncherBitset       *dest,
+                         const ApplauncherBitset *src)
+{
+	g_return_if_fail (dest != NULL);
+	g_return_if_fail (src != NULL);
+
+	if (dest->n_words != src->n_words)
+		applauncher_bitset_resize (dest, src->n_bits);
+
+	dest->n_bits = src->n_bits;
+	if (src->n_words)
+		memcpy (dest->words, src->words, src->n_words * sizeof (gulong));
+}
+
+/* dest 에 src 와의 교집합을 남긴다. src 범위를 벗어난 비트는 지운다. */
+void
+applauncher_bitset_and (ApplauncherBitset       *dest,
+                        const ApplauncherBitset *src)
+{
+	guint i, n_words;
+
+	g_return_if_fail (dest != NULL);
+	g_return_if_fail (src != NULL);
+
+	n_words = MIN (dest->n_words, src->n_words);
+
+	for (i = 0; i < n_words; i++)
+		dest->words[i] &= src->words[i];
+
+	for (; i < dest->n_words; i++)
+		dest->words[i] = 0;
+}
+
+/* prev 다음에 설정된 비트의 위치를 돌려준다. 처음부터 찾으려면 -1 을 넘긴다.
+ * 더 이상 없으면 -1 을 돌려준다. */
+gint
+applauncher_bitset_next (const ApplauncherBitset *bitset,
+                         gint                     prev)
+{
+	guint w;
+	gint nth;
+
+	g_return_val_if_fail (bitset != NULL, -1);
+
+	if (prev + 1 >= (gint)bitset->n_bits)
+		return -1;
+
+	w = (prev + 1) / WORD_BITS;
+	nth = g_bit_nth_lsf (bitset->words[w], (gint)((prev + 1) % WORD_BITS) - 1);
+
+	while (nth < 0) {
+		if (++w >= bitset->n_words)
+			return -1;
+		nth = g_bit_nth_lsf (bitset->words[w], -1);
+	}
+
+	nth += w * WORD_BITS;
+
+	return (nth < (gint)bitset->n_bits) ? nth : -1;
+}
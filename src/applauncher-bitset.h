@@ -0,0 +1,61 @@
+/*
+ *  Copyright (C) 2018-2021 Gooroom <gooroom@gooroom.kr>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#ifndef __APPLAUNCHER_BITSET_H__
+#define __APPLAUNCHER_BITSET_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* 카탈로그 항목 인덱스의 집합 */
+typedef struct _ApplauncherBitset ApplauncherBitset;
+
+ApplauncherBitset *applauncher_bitset_new      (guint                    n_bits);
+
+void               applauncher_bitset_free     (ApplauncherBitset       *bitset);
+
+guint              applauncher_bitset_get_size (const ApplauncherBitset *bitset);
+
+void               applauncher_bitset_resize   (ApplauncherBitset       *bitset,
+                                                guint                    n_bits);
+
+void               applauncher_bitset_clear    (ApplauncherBitset       *bitset);
+
+void               applauncher_bitset_add      (ApplauncherBitset       *bitset,
+                                                guint                    bit);
+
+void               applauncher_bitset_remove   (ApplauncherBitset       *bitset,
+                                                guint                    bit);
+
+gboolean           applauncher_bitset_contains (const ApplauncherBitset *bitset,
+                                                guint                    bit);
+
+void               applauncher_bitset_copy     (ApplauncherBitset       *dest,
+                                                const ApplauncherBitset *src);
+
+void               applauncher_bitset_and      (ApplauncherBitset       *dest,
+                                                const ApplauncherBitset *src);
+
+gint               applauncher_bitset_next     (const ApplauncherBitset *bitset,
+                                                gint                     prev);
+
+G_END_DECLS
+
+#endif /* !__APPLAUNCHER_BITSET_H__ */
@@ -0,0 +1,535 @@
+/*
+ *  Copyright (C) 2018-2021 Gooroom <gooroom@gooroom.kr>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <sys/stat.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <gio/gio.h>
+
+#include "applauncher-blacklist.h"
+
+
+/* 실행 파일별 상태. 블랙리스트 처리된 앱은 실행 파일에 다른 사용자의
+ * 실행 권한(S_IXOTH)이 없다. 확인은 스레드 풀에서 하며, 결과는 파일이
+ * 바뀔 때까지 재사용한다. */
+typedef struct
+{
+	ApplauncherBlacklist *blacklist;
+
+	gchar        *program;  /* Exec 의 argv[0] 또는 TryExec */
+	gchar        *path;     /* PATH 에서 찾은 실행 파일, 없으면 NULL */
+	GFileMonitor *monitor;
+
+	guint64       ino;
+	guint         mode;
+
+	gboolean      validated;
+	gboolean      pending;
+	gboolean      blocked;
+} ProgramState;
+
+/* 작업 스레드에서 확인한 결과 */
+typedef struct
+{
+	gchar    *program;
+	gchar    *path;
+	gboolean  stat_ok;
+	guint64   ino;
+	guint     mode;
+} ValidationResult;
+
+struct _ApplauncherBlacklistPrivate
+{
+	GHashTable *programs;  /* 프로그램 -> ProgramState */
+	GHashTable *by_exec;   /* Exec -> ProgramState (programs 소유) */
+
+	GSettings  *settings;
+	GHashTable *desktop_ids; /* GSettings 의 blacklist 키 */
+
+	GThreadPool *pool;
+	guint        n_pending;      /* 결과를 기다리는 확인 수, 메인 스레드에서만 사용 */
+	gboolean     changed_pending; /* 확인이 모두 끝나면 "changed" 를 한 번 보낸다 */
+
+	GMutex     lock;       /* results, results_idle_id 보호 */
+	GPtrArray *results;
+	guint      results_idle_id;
+};
+
+#define MAX_VALIDATION_THREADS 4
+
+#define APPLAUNCHER_SCHEMA     "apps.gooroom-applauncher-applet"
+#define BLACKLIST_KEY          "blacklist"
+
+enum {
+	CHANGED,
+	LAST_SIGNAL
+};
+
+static guint signals[LAST_SIGNAL] = { 0 };
+
+
+G_DEFINE_TYPE_WITH_PRIVATE (ApplauncherBlacklist, applauncher_blacklist, G_TYPE_OBJECT)
+
+
+static void program_monitor_changed_cb (GFileMonitor      *monitor,
+                                        GFile             *file,
+                                        GFile             *other_file,
+                                        GFileMonitorEvent  event_type,
+                                        gpointer           data);
+
+static gboolean results_idle (gpointer data);
+
+static void
+validation_result_free (ValidationResult *result)
+{
+	g_free (result->program);
+	g_free (result->path);
+
+	g_slice_free (ValidationResult, result);
+}
+
+static void
+program_state_clear_monitor (ProgramState *state)
+{
+	if (state->monitor) {
+		g_signal_handlers_disconnect_by_func (state->monitor, program_monitor_changed_cb, state);
+		g_file_monitor_cancel (state->monitor);
+		g_clear_object (&state->monitor);
+	}
+}
+
+static void
+program_state_free (ProgramState *state)
+{
+	program_state_clear_monitor (state);
+
+	g_free (state->program);
+	g_free (state->path);
+
+	g_slice_free (ProgramState, state);
+}
+
+static void
+program_state_set_monitor (ProgramState *state)
+{
+	GFile *file;
+
+	program_state_clear_monitor (state);
+
+	if (!state->path)
+		return;
+
+	file = g_file_new_for_path (state->path);
+	state->monitor = g_file_monitor_file (file, G_FILE_MONITOR_NONE, NULL, NULL);
+	if (state->monitor) {
+		g_signal_connect (state->monitor, "changed",
+                          G_CALLBACK (program_monitor_changed_cb), state);
+	}
+	g_object_unref (file);
+}
+
+/* 작업 스레드에서 실행된다. */
+static void
+validate_program_func (gpointer data,
+                       gpointer user_data)
+{
+	GStatBuf buf;
+	ValidationResult *result;
+	ApplauncherBlacklist *blacklist = APPLAUNCHER_BLACKLIST (user_data);
+	ApplauncherBlacklistPrivate *priv = blacklist->priv;
+
+	result = g_slice_new0 (ValidationResult);
+	result->program = data;
+	result->path = g_find_program_in_path (result->program);
+
+	if (result->path && g_stat (result->path, &buf) == 0) {
+		result->stat_ok = TRUE;
+		result->ino = (guint64)buf.st_ino;
+		result->mode = buf.st_mode;
+	}
+
+	g_mutex_lock (&priv->lock);
+	g_ptr_array_add (priv->results, result);
+	if (priv->results_idle_id == 0)
+		priv->results_idle_id = g_idle_add (results_idle, blacklist);
+	g_mutex_unlock (&priv->lock);
+}
+
+static void
+queue_validation (ProgramState *state)
+{
+	ApplauncherBlacklistPrivate *priv = state->blacklist->priv;
+
+	if (state->pending)
+		return;
+
+	state->pending = TRUE;
+	priv->n_pending++;
+	g_thread_pool_push (priv->pool, g_strdup (state->program), NULL);
+}
+
+/* 작업 스레드에서 모인 결과를 메인 루프에서 한꺼번에 반영한다. */
+static gboolean
+results_idle (gpointer data)
+{
+	guint i;
+	GPtrArray *results;
+	gboolean changed = FALSE;
+	ApplauncherBlacklist *blacklist = APPLAUNCHER_BLACKLIST (data);
+	ApplauncherBlacklistPrivate *priv = blacklist->priv;
+
+	g_mutex_lock (&priv->lock);
+	results = priv->results;
+	priv->results = g_ptr_array_new_with_free_func ((GDestroyNotify)validation_result_free);
+	priv->results_idle_id = 0;
+	g_mutex_unlock (&priv->lock);
+
+	for (i = 0; i < results->len; i++) {
+		gboolean blocked, found, replaced;
+		ValidationResult *result = g_ptr_array_index (results, i);
+		ProgramState *state = g_hash_table_lookup (priv->programs, result->program);
+
+		priv->n_pending--;
+
+		if (!state)
+			continue;
+
+		state->pending = FALSE;
+
+		/* 내용만 바뀐 경우처럼 경로, inode, 권한이 그대로면 다시 판단할 것이 없다.
+		 * 찾은 파일을 stat 하지 못했으면 이전 판단을 유지한다. */
+		if (state->validated &&
+            ((result->path && !result->stat_ok) ||
+             (g_strcmp0 (state->path, result->path) == 0 &&
+              state->ino == result->ino && state->mode == result->mode)))
+			continue;
+
+		found = (state->path != NULL);
+		blocked = state->blocked;
+		replaced = (state->ino != result->ino);
+
+		state->ino = result->ino;
+		state->mode = result->mode;
+		/* 처음 확인할 때 stat 하지 못했으면 막지 않는다. */
+		state->blocked = (result->path && result->stat_ok && !(result->mode & S_IXOTH));
+
+		if (!result->path) {
+			/* 지워진 경우 다시 생기는 것을 알 수 있도록 감시는 유지한다. */
+			g_clear_pointer (&state->path, g_free);
+		} else if (g_strcmp0 (state->path, result->path) != 0 || replaced || !state->monitor) {
+			/* 다른 파일로 바뀌었으면 새 파일을 감시한다. */
+			g_free (state->path);
+			state->path = g_steal_pointer (&result->path);
+			program_state_set_monitor (state);
+		}
+
+		/* 확인되기 전에는 막지 않은 상태로 취급한다. */
+		if (!state->validated) {
+			state->validated = TRUE;
+			if (state->blocked || !state->path)
+				changed = TRUE;
+		} else if (state->blocked != blocked || (state->path != NULL) != found) {
+			changed = TRUE;
+		}
+	}
+
+	g_ptr_array_unref (results);
+
+	/* 시작할 때는 수백 개의 결과가 여러 번에 나뉘어 오므로
+	 * 대기 중인 확인이 모두 끝난 뒤에 한 번만 알린다. */
+	if (changed)
+		priv->changed_pending = TRUE;
+
+	if (priv->changed_pending && priv->n_pending == 0) {
+		priv->changed_pending = FALSE;
+		g_signal_emit (G_OBJECT (blacklist), signals[CHANGED], 0);
+	}
+
+	return FALSE;
+}
+
+static void
+program_monitor_changed_cb (GFileMonitor      *monitor,
+                            GFile             *file,
+                            GFile             *other_file,
+                            GFileMonitorEvent  event_type,
+                            gpointer           data)
+{
+	ProgramState *state = data;
+
+	switch (event_type) {
+		case G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT:
+		case G_FILE_MONITOR_EVENT_ATTRIBUTE_CHANGED:
+		case G_FILE_MONITOR_EVENT_DELETED:
+		case G_FILE_MONITOR_EVENT_CREATED:
+		case G_FILE_MONITOR_EVENT_MOVED_IN:
+		case G_FILE_MONITOR_EVENT_MOVED_OUT:
+		case G_FILE_MONITOR_EVENT_RENAMED:
+			break;
+
+		default:
+			return;
+	}
+
+	/* inode 나 권한이 바뀌었는지는 작업 스레드에서 다시 확인한다. */
+	queue_validation (state);
+}
+
+static ProgramState *
+lookup_program_name (ApplauncherBlacklist *blacklist,
+                     const gchar          *program)
+{
+	ProgramState *state;
+	ApplauncherBlacklistPrivate *priv = blacklist->priv;
+
+	state = g_hash_table_lookup (priv->programs, program);
+	if (!state) {
+		state = g_slice_new0 (ProgramState);
+		state->blacklist = blacklist;
+		state->program = g_strdup (program);
+
+		g_hash_table_insert (priv->programs, state->program, state);
+
+		queue_validation (state);
+	}
+
+	return state;
+}
+
+static ProgramState *
+lookup_program (ApplauncherBlacklist *blacklist,
+                const gchar          *exec)
+{
+	gint argc = 0;
+	gchar **argv = NULL;
+	ProgramState *state;
+	ApplauncherBlacklistPrivate *priv = blacklist->priv;
+
+	state = g_hash_table_lookup (priv->by_exec, exec);
+	if (state)
+		return state;
+
+	if (!g_shell_parse_argv (exec, &argc, &argv, NULL) || argc == 0) {
+		g_strfreev (argv);
+		return NULL;
+	}
+
+	state = lookup_program_name (blacklist, argv[0]);
+
+	g_hash_table_insert (priv->by_exec, g_strdup (exec), state);
+
+	g_strfreev (argv);
+
+	return state;
+}
+
+/* 관리자가 수백 개의 id 를 넣을 수 있으므로 해시 집합으로 만들어 둔다. */
+static void
+load_desktop_ids (ApplauncherBlacklist *blacklist)
+{
+	guint i;
+	gchar **ids;
+	ApplauncherBlacklistPrivate *priv = blacklist->priv;
+
+	g_hash_table_remove_all (priv->desktop_ids);
+
+	if (!priv->settings)
+		return;
+
+	ids = g_settings_get_strv (priv->settings, BLACKLIST_KEY);
+	for (i = 0; ids[i]; i++) {
+		if (ids[i][0] != '\0')
+			g_hash_table_add (priv->desktop_ids, g_strdup (ids[i]));
+	}
+	g_strfreev (ids);
+}
+
+static void
+settings_blacklist_changed_cb (GSettings   *settings,
+                               const gchar *key,
+                               gpointer     data)
+{
+	ApplauncherBlacklist *blacklist = APPLAUNCHER_BLACKLIST (data);
+
+	load_desktop_ids (blacklist);
+
+	g_signal_emit (G_OBJECT (blacklist), signals[CHANGED], 0);
+}
+
+static void
+applauncher_blacklist_dispose (GObject *object)
+{
+	ApplauncherBlacklist *blacklist = APPLAUNCHER_BLACKLIST (object);
+	ApplauncherBlacklistPrivate *priv = blacklist->priv;
+
+	if (priv->settings) {
+		g_signal_handlers_disconnect_by_func (priv->settings, settings_blacklist_changed_cb, blacklist);
+		g_clear_object (&priv->settings);
+	}
+
+	G_OBJECT_CLASS (applauncher_blacklist_parent_class)->dispose (object);
+}
+
+static void
+applauncher_blacklist_finalize (GObject *object)
+{
+	ApplauncherBlacklist *blacklist = APPLAUNCHER_BLACKLIST (object);
+	ApplauncherBlacklistPrivate *priv = blacklist->priv;
+
+	/* 대기 중인 작업은 버리고 실행 중인 작업이 끝나기를 기다린다. */
+	g_thread_pool_free (priv->pool, TRUE, TRUE);
+
+	if (priv->results_idle_id != 0) {
+		g_source_remove (priv->results_idle_id);
+		priv->results_idle_id = 0;
+	}
+	g_ptr_array_unref (priv->results);
+	g_mutex_clear (&priv->lock);
+
+	g_hash_table_destroy (priv->by_exec);
+	g_hash_table_destroy (priv->programs);
+	g_hash_table_destroy (priv->desktop_ids);
+
+	G_OBJECT_CLASS (applauncher_blacklist_parent_class)->finalize (object);
+}
+
+static void
+applauncher_blacklist_init (ApplauncherBlacklist *blacklist)
+{
+	GSettingsSchema *schema = NULL;
+	GSettingsSchemaSource *source;
+	ApplauncherBlacklistPrivate *priv;
+
+	priv = blacklist->priv = applauncher_blacklist_get_instance_private (blacklist);
+
+	priv->programs = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                            NULL, (GDestroyNotify)program_state_free);
+	priv->by_exec = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	priv->desktop_ids = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+	/* 스키마가 설치되지 않은 경우에도 동작하도록 먼저 확인한다. */
+	priv->settings = NULL;
+	source = g_settings_schema_source_get_default ();
+	if (source)
+		schema = g_settings_schema_source_lookup (source, APPLAUNCHER_SCHEMA, TRUE);
+
+	if (schema) {
+		if (g_settings_schema_has_key (schema, BLACKLIST_KEY)) {
+			priv->settings = g_settings_new_full (schema, NULL, NULL);
+			g_signal_connect (priv->settings, "changed::" BLACKLIST_KEY,
+                              G_CALLBACK (settings_blacklist_changed_cb), blacklist);
+		}
+		g_settings_schema_unref (schema);
+	} else {
+		g_warning ("Settings schema '%s' is not installed", APPLAUNCHER_SCHEMA);
+	}
+
+	load_desktop_ids (blacklist);
+
+	g_mutex_init (&priv->lock);
+	priv->results = g_ptr_array_new_with_free_func ((GDestroyNotify)validation_result_free);
+	priv->results_idle_id = 0;
+	priv->n_pending = 0;
+	priv->changed_pending = FALSE;
+
+	priv->pool = g_thread_pool_new (validate_program_func, blacklist,
+                                    MAX_VALIDATION_THREADS, FALSE, NULL);
+}
+
+static void
+applauncher_blacklist_class_init (ApplauncherBlacklistClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+	object_class->dispose = applauncher_blacklist_dispose;
+	object_class->finalize = applauncher_blacklist_finalize;
+
+	signals[CHANGED] = g_signal_new ("changed",
+                                     APPLAUNCHER_TYPE_BLACKLIST,
+                                     G_SIGNAL_RUN_LAST,
+                                     G_STRUCT_OFFSET (ApplauncherBlacklistClass,
+                                     changed),
+                                     NULL, NULL,
+                                     g_cclosure_marshal_VOID__VOID,
+                                     G_TYPE_NONE, 0);
+}
+
+ApplauncherBlacklist *
+applauncher_blacklist_new (void)
+{
+	return g_object_new (APPLAUNCHER_TYPE_BLACKLIST, NULL);
+}
+
+/* 아직 확인하지 않은 실행 파일은 확인을 요청하고 FALSE 를 반환한다.
+ * 막아야 하는 것으로 확인되면 "changed" 시그널로 알린다. */
+gboolean
+applauncher_blacklist_is_blocked (ApplauncherBlacklist    *blacklist,
+                                  ApplauncherCatalogEntry *entry)
+{
+	ProgramState *state;
+
+	g_return_val_if_fail (APPLAUNCHER_IS_BLACKLIST (blacklist), FALSE);
+	g_return_val_if_fail (entry != NULL, FALSE);
+
+	ApplauncherBlacklistPrivate *priv = blacklist->priv;
+
+	/* blacklist 키에는 desktop id 나 데스크톱 파일 경로를 넣을 수 있다. */
+	if (g_hash_table_size (priv->desktop_ids) > 0) {
+		if ((entry->desktop_id && g_hash_table_contains (priv->desktop_ids, entry->desktop_id)) ||
+            (entry->path && g_hash_table_contains (priv->desktop_ids, entry->path)))
+			return TRUE;
+	}
+
+	if (entry->exec && entry->exec[0] != '\0') {
+		state = lookup_program (blacklist, entry->exec);
+		if (state && state->validated && state->blocked)
+			return TRUE;
+	}
+
+	/* TryExec 프로그램이 없으면 보여주지 않는다. */
+	if (entry->try_exec && entry->try_exec[0] != '\0') {
+		state = lookup_program_name (blacklist, entry->try_exec);
+		if (state->validated && !state->path)
+			return TRUE;
+	}
+
+	return FALSE;
+}
+
+/* PATH 에서 찾지 못한 프로그램은 감시할 파일이 없으므로,
+ * 카탈로그를 다시 읽을 때 새로 설치되었는지 다시 확인한다. */
+void
+applauncher_blacklist_revalidate_missing (ApplauncherBlacklist *blacklist)
+{
+	GHashTableIter iter;
+	ProgramState *state;
+
+	g_return_if_fail (APPLAUNCHER_IS_BLACKLIST (blacklist));
+
+	g_hash_table_iter_init (&iter, blacklist->priv->programs);
+	while (g_hash_table_iter_next (&iter, NULL, (gpointer *)&state)) {
+		if (state->validated && !state->path)
+			queue_validation (state);
+	}
+}
@@ -0,0 +1,67 @@
+/*
+ *  Copyright (C) 2018-2021 Gooroom <gooroom@gooroom.kr>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#ifndef __APPLAUNCHER_BLACKLIST_H__
+#define __APPLAUNCHER_BLACKLIST_H__
+
+#include <gio/gio.h>
+
+#include "applauncher-catalog.h"
+
+G_BEGIN_DECLS
+
+#define APPLAUNCHER_TYPE_BLACKLIST            (applauncher_blacklist_get_type ())
+#define APPLAUNCHER_BLACKLIST(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), APPLAUNCHER_TYPE_BLACKLIST, ApplauncherBlacklist))
+#define APPLAUNCHER_BLACKLIST_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass), APPLAUNCHER_TYPE_BLACKLIST, ApplauncherBlacklistClass))
+#define APPLAUNCHER_IS_BLACKLIST(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), APPLAUNCHER_TYPE_BLACKLIST))
+#define APPLAUNCHER_IS_BLACKLIST_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), APPLAUNCHER_TYPE_BLACKLIST))
+#define APPLAUNCHER_BLACKLIST_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj), APPLAUNCHER_TYPE_BLACKLIST, ApplauncherBlacklistClass))
+
+typedef struct _ApplauncherBlacklistPrivate ApplauncherBlacklistPrivate;
+typedef struct _ApplauncherBlacklistClass   ApplauncherBlacklistClass;
+typedef struct _ApplauncherBlacklist        ApplauncherBlacklist;
+
+struct _ApplauncherBlacklistClass
+{
+	GObjectClass __parent_class__;
+
+	/*< signals >*/
+	void (*changed)(ApplauncherBlacklist *blacklist);
+};
+
+struct _ApplauncherBlacklist
+{
+	GObject __parent__;
+
+	ApplauncherBlacklistPrivate *priv;
+};
+
+
+GType                 applauncher_blacklist_get_type   (void) G_GNUC_CONST;
+
+ApplauncherBlacklist *applauncher_blacklist_new                (void);
+
+gboolean              applauncher_blacklist_is_blocked         (ApplauncherBlacklist    *blacklist,
+                                                                ApplauncherCatalogEntry *entry);
+
+void                  applauncher_blacklist_revalidate_missing (ApplauncherBlacklist    *blacklist);
+
+G_END_DECLS
+
+#endif /* !__APPLAUNCHER_BLACKLIST_H__ */
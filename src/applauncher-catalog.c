@@ -0,0 +1,1151 @@
+/*
+ *  Copyright (C) 2018-2021 Gooroom <gooroom@gooroom.kr>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string.h>
+
+#include <glib.h>
+#include <gio/gdesktopappinfo.h>
+
+#include <gmenu-tree.h>
+
+#include "applauncher-catalog.h"
+#include "applauncher-blacklist.h"
+#include "applauncher-hangul.h"
+#include "applauncher-snapshot.h"
+
+
+#define RELOAD_DELAY 1000 /* ms */
+
+struct _ApplauncherCatalogPrivate
+{
+	GMenuTree *tree;
+
+	GAppInfoMonitor *monitor;
+
+	ApplauncherBlacklist *blacklist;
+
+	GPtrArray *dirs;
+	GPtrArray *entries;
+
+	ApplauncherBitset *visible;    /* 블랙리스트에 걸리지 않은 항목 */
+	ApplauncherSearchIndex *index;
+
+	guint generation;
+	guint reload_timeout_id;
+
+	GCancellable *cancellable;     /* 카탈로그가 해제될 때 읽기 작업을 취소한다 */
+
+	gboolean loaded;
+	gboolean loading;
+	gboolean reload_pending;
+};
+
+/* 작업 스레드에서 만든 결과를 메인 스레드로 넘기기 위한 구조체 */
+typedef struct
+{
+	GMenuTree *tree;
+
+	GPtrArray *dirs;
+	GPtrArray *entries;
+
+	ApplauncherSearchIndex *index;
+} CatalogData;
+
+
+enum {
+	CHANGED,
+	LAST_SIGNAL
+};
+
+static guint signals[LAST_SIGNAL] = { 0 };
+
+
+G_DEFINE_TYPE_WITH_PRIVATE (ApplauncherCatalog, applauncher_catalog, G_TYPE_OBJECT)
+
+
+/* 최상위 디렉토리 하나가 차지하는 평탄화된 응용 프로그램 배열의 범위 */
+typedef struct
+{
+	GMenuTreeDirectory *directory;
+	guint               start;
+	guint               end;
+} DirectoryRun;
+
+static void collect_applications_from_dir (GMenuTreeDirectory *directory,
+                                           GPtrArray          *apps,
+                                           GArray             *runs);
+
+static gchar *
+get_applications_menu (void)
+{
+	return g_strdup ("gnome-applications.menu");
+}
+
+static gboolean
+is_chrome_apps_directory (GMenuTreeDirectory *directory)
+{
+	const gchar *path = gmenu_tree_directory_get_desktop_file_path (directory);
+
+	return (path && g_str_has_suffix (path, "chrome-apps.directory"));
+}
+
+static gint
+applications_compare_by_id (gconstpointer a, gconstpointer b)
+{
+	GAppInfo *app_a = NULL;
+	GAppInfo *app_b = NULL;
+	const gchar *id_a = NULL;
+	const gchar *id_b = NULL;
+
+	app_a = G_APP_INFO (gmenu_tree_entry_get_app_info (*(GMenuTreeEntry **)a));
+	app_b = G_APP_INFO (gmenu_tree_entry_get_app_info (*(GMenuTreeEntry **)b));
+
+	if (app_a)
+		id_a = g_app_info_get_id ((GAppInfo *)app_a);
+	if (app_b)
+		id_b = g_app_info_get_id ((GAppInfo *)app_b);
+
+	if (id_a == NULL && id_b == NULL)
+		return 0;
+	if (id_a == NULL)
+		return -1;
+	if (id_b == NULL)
+		return 1;
+
+	return strcmp (id_a, id_b);
+}
+
+/* Based on gnome-panel-3.26.0/gnome-panel/panel-run-dialog.c:
+ * get_all_applications_from_alias () */
+static void
+collect_applications_from_alias (GMenuTreeAlias *alias,
+                                 GPtrArray      *apps)
+{
+	switch (gmenu_tree_alias_get_aliased_item_type (alias))
+	{
+		case GMENU_TREE_ITEM_ENTRY: {
+			GMenuTreeEntry *entry = gmenu_tree_alias_get_aliased_entry (alias);
+			g_ptr_array_add (apps, entry);
+			break;
+		}
+
+		case GMENU_TREE_ITEM_DIRECTORY: {
+			GMenuTreeDirectory *directory = gmenu_tree_alias_get_aliased_directory (alias);
+			collect_applications_from_dir (directory, apps, NULL);
+			gmenu_tree_item_unref (directory);
+			break;
+		}
+
+		default:
+			break;
+	}
+}
+
+/* Based on gnome-panel-3.26.0/gnome-panel/panel-run-dialog.c:
+ * get_all_applications_from_dir ()
+ *
+ * 한 번의 순회로 모든 항목을 apps 뒤에 덧붙인다. 정렬은 호출한 쪽에서 한 번만 한다.
+ * runs 가 주어지면 최상위 디렉토리마다 apps 에서 차지하는 범위를 기록한다. */
+static void
+collect_applications_from_dir (GMenuTreeDirectory  *directory,
+                               GPtrArray           *apps,
+                               GArray              *runs)
+{
+	GMenuTreeIter *iter;
+	GMenuTreeItemType next_type;
+
+	iter = gmenu_tree_directory_iter (directory);
+
+	while ((next_type = gmenu_tree_iter_next (iter)) != GMENU_TREE_ITEM_INVALID) {
+		switch (next_type) {
+			case GMENU_TREE_ITEM_ENTRY: {
+				g_ptr_array_add (apps, gmenu_tree_iter_get_entry (iter));
+				break;
+			}
+
+			case GMENU_TREE_ITEM_DIRECTORY: {
+				GMenuTreeDirectory *dir = gmenu_tree_iter_get_directory (iter);
+				if (is_chrome_apps_directory (dir)) {
+					gmenu_tree_item_unref (dir);
+					break;
+				}
+				if (runs) {
+					DirectoryRun run;
+					run.directory = dir;
+					run.start = apps->len;
+					collect_applications_from_dir (dir, apps, NULL);
+					run.end = apps->len;
+					g_array_append_val (runs, run);
+					break;
+				}
+				collect_applications_from_dir (dir, apps, NULL);
+				gmenu_tree_item_unref (dir);
+				break;
+			}
+
+			case GMENU_TREE_ITEM_ALIAS: {
+				GMenuTreeAlias *alias = gmenu_tree_iter_get_alias (iter);
+				collect_applications_from_alias (alias, apps);
+				gmenu_tree_item_unref (alias);
+				break;
+			}
+
+			default:
+			break;
+		}
+	}
+
+	gmenu_tree_iter_unref (iter);
+}
+
+static void
+catalog_data_free (CatalogData *data)
+{
+	g_clear_pointer (&data->dirs, g_ptr_array_unref);
+	g_clear_pointer (&data->index, applauncher_search_index_unref);
+	g_clear_pointer (&data->entries, g_ptr_array_unref);
+	g_clear_object (&data->tree);
+
+	g_slice_free (CatalogData, data);
+}
+
+static ApplauncherCatalogEntry *
+catalog_entry_new_from_tree_entry (GMenuTreeEntry *tree_entry)
+{
+	GIcon *icon;
+	const gchar * const *keywords;
+	GDesktopAppInfo *dt_info;
+	ApplauncherCatalogEntry *entry;
+
+	dt_info = gmenu_tree_entry_get_app_info (tree_entry);
+	if (!dt_info)
+		return NULL;
+
+	entry = applauncher_catalog_entry_new ();
+	entry->desktop_id = g_strdup (g_app_info_get_id (G_APP_INFO (dt_info)));
+	if (!entry->desktop_id)
+		entry->desktop_id = g_strdup (gmenu_tree_entry_get_desktop_file_id (tree_entry));
+	entry->path = g_strdup (g_desktop_app_info_get_filename (dt_info));
+	entry->name = g_strdup (g_app_info_get_name (G_APP_INFO (dt_info)));
+	entry->untranslated_name = g_desktop_app_info_get_string (dt_info, G_KEY_FILE_DESKTOP_KEY_NAME);
+	entry->description = g_strdup (g_app_info_get_description (G_APP_INFO (dt_info)));
+	entry->generic_name = g_strdup (g_desktop_app_info_get_generic_name (dt_info));
+	keywords = g_desktop_app_info_get_keywords (dt_info);
+	entry->keywords = (keywords && keywords[0]) ? g_strjoinv (";", (gchar **)keywords) : NULL;
+	entry->categories = g_strdup (g_desktop_app_info_get_categories (dt_info));
+	entry->exec = g_desktop_app_info_get_string (dt_info, G_KEY_FILE_DESKTOP_KEY_EXEC);
+	entry->try_exec = g_desktop_app_info_get_string (dt_info, G_KEY_FILE_DESKTOP_KEY_TRY_EXEC);
+
+	icon = g_app_info_get_icon (G_APP_INFO (dt_info));
+	entry->icon = icon ? g_icon_to_string (icon) : NULL;
+
+	return entry;
+}
+
+static gint
+compare_index (gconstpointer a, gconstpointer b)
+{
+	guint ia = *(const guint *)a;
+	guint ib = *(const guint *)b;
+
+	return (ia < ib) ? -1 : (ia > ib);
+}
+
+static ApplauncherCatalogDirectory *
+catalog_directory_new_from_tree_directory (GMenuTreeDirectory *tree_dir,
+                                           GPtrArray          *apps,
+                                           guint               start,
+                                           guint               end,
+                                           GHashTable         *index_by_id,
+                                           guint               n_entries)
+{
+	GIcon *icon;
+	guint i;
+	ApplauncherCatalogDirectory *dir;
+
+	dir = applauncher_catalog_directory_new ();
+	dir->path = g_strdup (gmenu_tree_directory_get_desktop_file_path (tree_dir));
+
+	if (dir->path) {
+		dir->name = g_strdup (gmenu_tree_directory_get_name (tree_dir));
+		icon = gmenu_tree_directory_get_icon (tree_dir);
+		dir->icon = icon ? g_icon_to_string (icon) : NULL;
+	}
+
+	if (!dir->path) {
+		/* 루트 디렉토리는 전체 프로그램이다. */
+		for (i = 0; i < n_entries; i++)
+			g_array_append_val (dir->members, i);
+		return dir;
+	}
+
+	for (i = start; i < end; i++) {
+		gpointer value;
+		GMenuTreeEntry *tree_entry = g_ptr_array_index (apps, i);
+		const gchar *id = gmenu_tree_entry_get_desktop_file_id (tree_entry);
+
+		if (id && g_hash_table_lookup_extended (index_by_id, id, NULL, &value)) {
+			guint index = GPOINTER_TO_UINT (value);
+			g_array_append_val (dir->members, index);
+		}
+	}
+
+	/* 인덱스가 desktop id 순서이므로 한 번 정렬하면 표시 순서가 된다.
+	 * 별칭으로 두 번 등록된 항목은 여기서 제거한다. */
+	g_array_sort (dir->members, compare_index);
+	if (dir->members->len > 1) {
+		guint n = 1;
+		for (i = 1; i < dir->members->len; i++) {
+			if (g_array_index (dir->members, guint, i) != g_array_index (dir->members, guint, n - 1))
+				g_array_index (dir->members, guint, n++) = g_array_index (dir->members, guint, i);
+		}
+		g_array_set_size (dir->members, n);
+	}
+
+	return dir;
+}
+
+/* 메뉴 트리를 한 번만 순회해서 디렉토리 목록과 전체 응용 프로그램 목록을 만든다. */
+static CatalogData *
+catalog_data_new_from_tree (GMenuTree     *tree,
+                            GCancellable  *cancellable)
+{
+	guint i;
+	GPtrArray *apps, *sorted;
+	GArray *runs;
+	GHashTable *index_by_id;
+	GMenuTreeDirectory *root;
+	CatalogData *data;
+
+	data = g_slice_new0 (CatalogData);
+	data->tree = g_object_ref (tree);
+	data->entries = g_ptr_array_new_with_free_func ((GDestroyNotify)applauncher_catalog_entry_free);
+	data->dirs = g_ptr_array_new_with_free_func ((GDestroyNotify)applauncher_catalog_directory_free);
+
+	root = gmenu_tree_get_root_directory (tree);
+	if (!root)
+		return data;
+
+	apps = g_ptr_array_new_full (256, (GDestroyNotify)gmenu_tree_item_unref);
+	runs = g_array_new (FALSE, FALSE, sizeof (DirectoryRun));
+
+	collect_applications_from_dir (root, apps, runs);
+
+	/* 전체 목록은 desktop id 순서로 한 번만 정렬하고 중복을 제거한다. */
+	sorted = g_ptr_array_sized_new (apps->len);
+	for (i = 0; i < apps->len; i++)
+		g_ptr_array_add (sorted, g_ptr_array_index (apps, i));
+	g_ptr_array_sort (sorted, applications_compare_by_id);
+
+	index_by_id = g_hash_table_new (g_str_hash, g_str_equal);
+
+	for (i = 0; i < sorted->len; i++) {
+		GMenuTreeEntry *tree_entry = g_ptr_array_index (sorted, i);
+		const gchar *id = gmenu_tree_entry_get_desktop_file_id (tree_entry);
+		ApplauncherCatalogEntry *entry;
+
+		if (!id || g_hash_table_contains (index_by_id, id))
+			continue;
+
+		entry = catalog_entry_new_from_tree_entry (tree_entry);
+		if (!entry)
+			continue;
+
+		entry->index = data->entries->len;
+		g_ptr_array_add (data->entries, entry);
+		g_hash_table_insert (index_by_id, (gpointer)id, GUINT_TO_POINTER (entry->index));
+	}
+
+	g_ptr_array_add (data->dirs,
+                     catalog_directory_new_from_tree_directory (root, apps, 0, 0, index_by_id,
+                                                                data->entries->len));
+
+	for (i = 0; i < runs->len && !g_cancellable_is_cancelled (cancellable); i++) {
+		DirectoryRun *run = &g_array_index (runs, DirectoryRun, i);
+
+		g_ptr_array_add (data->dirs,
+                         catalog_directory_new_from_tree_directory (run->directory, apps,
+                                                                    run->start, run->end,
+                                                                    index_by_id,
+                                                                    data->entries->len));
+	}
+
+	for (i = 0; i < runs->len; i++)
+		gmenu_tree_item_unref (g_array_index (runs, DirectoryRun, i).directory);
+
+	g_hash_table_destroy (index_by_id);
+	g_array_unref (runs);
+	g_ptr_array_unref (sorted);
+	g_ptr_array_unref (apps);
+	gmenu_tree_item_unref (root);
+
+	return data;
+}
+
+static gchar *
+get_exec_basename (const gchar *exec)
+{
+	gint argc = 0;
+	gchar **argv = NULL;
+	gchar *basename = NULL;
+
+	if (!exec || !g_shell_parse_argv (exec, &argc, &argv, NULL))
+		return NULL;
+
+	if (argc > 0)
+		basename = g_path_get_basename (argv[0]);
+
+	g_strfreev (argv);
+
+	return basename;
+}
+
+static void
+catalog_entry_prepare_search_key (ApplauncherCatalogEntry *entry)
+{
+	gchar *exec_basename, *name, *choseong;
+	const gchar *fields[APPLAUNCHER_SEARCH_N_FIELDS];
+
+	exec_basename = get_exec_basename (entry->exec);
+
+	/* 초성 검색을 위해 이름을 한 번만 분해해 둔다. */
+	name = applauncher_search_normalize (entry->name);
+	choseong = applauncher_hangul_get_choseong (name);
+
+	fields[APPLAUNCHER_SEARCH_FIELD_NAME] = entry->name;
+	fields[APPLAUNCHER_SEARCH_FIELD_UNTRANSLATED_NAME] = entry->untranslated_name;
+	fields[APPLAUNCHER_SEARCH_FIELD_GENERIC_NAME] = entry->generic_name;
+	fields[APPLAUNCHER_SEARCH_FIELD_KEYWORDS] = entry->keywords;
+	fields[APPLAUNCHER_SEARCH_FIELD_EXEC] = exec_basename;
+	fields[APPLAUNCHER_SEARCH_FIELD_CHOSEONG] = choseong;
+	fields[APPLAUNCHER_SEARCH_FIELD_COMMENT] = entry->description;
+	fields[APPLAUNCHER_SEARCH_FIELD_CATEGORIES] = entry->categories;
+
+	applauncher_search_key_unref (entry->search_key);
+	entry->search_key = applauncher_search_key_new (fields);
+
+	g_free (exec_basename);
+	g_free (choseong);
+	g_free (name);
+}
+
+/* 스냅샷에 저장하지 않는 파생 값들을 미리 계산한다. */
+static void
+catalog_data_prepare (CatalogData *data)
+{
+	guint i, m;
+	ApplauncherSearchKey **keys;
+
+	keys = g_new0 (ApplauncherSearchKey *, MAX (data->entries->len, 1));
+
+	for (i = 0; i < data->entries->len; i++) {
+		ApplauncherCatalogEntry *entry = g_ptr_array_index (data->entries, i);
+
+		entry->name_hash = entry->name ? g_str_hash (entry->name) : 0;
+		catalog_entry_prepare_search_key (entry);
+		keys[i] = entry->search_key;
+	}
+
+	data->index = applauncher_search_index_new (keys, data->entries->len);
+	g_free (keys);
+
+	for (i = 0; i < data->dirs->len; i++) {
+		ApplauncherCatalogDirectory *dir = g_ptr_array_index (data->dirs, i);
+
+		applauncher_bitset_resize (dir->member_set, data->entries->len);
+		for (m = 0; m < dir->members->len; m++)
+			applauncher_bitset_add (dir->member_set, g_array_index (dir->members, guint, m));
+	}
+}
+
+/* 스냅샷이 유효하면 메뉴 트리를 읽지 않고 스냅샷에서 바로 카탈로그를 만든다.
+ * 작업 스레드에서 호출되므로 GTK 함수를 사용하지 않는다. */
+static CatalogData *
+catalog_data_load (gboolean       use_snapshot,
+                   GCancellable  *cancellable,
+                   GError       **error)
+{
+	GMenuTree *tree;
+	CatalogData *data;
+	GPtrArray *entries = NULL, *dirs = NULL;
+	gchar *applications_menu, *snapshot_path;
+	guint64 stamp;
+
+	if (g_cancellable_set_error_if_cancelled (cancellable, error))
+		return NULL;
+
+	applications_menu = get_applications_menu ();
+	snapshot_path = applauncher_snapshot_get_path ();
+	stamp = applauncher_snapshot_compute_stamp (applications_menu);
+
+	if (use_snapshot && applauncher_snapshot_load (snapshot_path, stamp, &entries, &dirs)) {
+		data = g_slice_new0 (CatalogData);
+		data->entries = entries;
+		data->dirs = dirs;
+		goto out;
+	}
+
+	tree = gmenu_tree_new (applications_menu, GMENU_TREE_FLAGS_SORT_DISPLAY_NAME);
+
+	if (!gmenu_tree_load_sync (tree, error)) {
+		g_object_unref (tree);
+		data = NULL;
+		goto out;
+	}
+
+	data = catalog_data_new_from_tree (tree, cancellable);
+	g_object_unref (tree);
+
+	if (!g_cancellable_is_cancelled (cancellable)) {
+		GError *save_error = NULL;
+		if (!applauncher_snapshot_save (snapshot_path, stamp, data->entries, data->dirs, &save_error)) {
+			g_warning ("Failed to save catalog snapshot: %s", save_error->message);
+			g_error_free (save_error);
+		}
+	}
+
+out:
+	g_free (snapshot_path);
+	g_free (applications_menu);
+
+	if (data)
+		catalog_data_prepare (data);
+
+	if (data && g_cancellable_set_error_if_cancelled (cancellable, error)) {
+		catalog_data_free (data);
+		return NULL;
+	}
+
+	return data;
+}
+
+static void
+catalog_load_thread (GTask        *task,
+                     gpointer      source_object,
+                     gpointer      task_data,
+                     GCancellable *cancellable)
+{
+	CatalogData *data;
+	GError *error = NULL;
+
+	data = catalog_data_load (GPOINTER_TO_INT (task_data), cancellable, &error);
+
+	if (data)
+		g_task_return_pointer (task, data, (GDestroyNotify)catalog_data_free);
+	else
+		g_task_return_error (task, error);
+}
+
+static void
+catalog_load_async_full (ApplauncherCatalog  *catalog,
+                         gboolean             use_snapshot,
+                         GCancellable        *cancellable,
+                         GAsyncReadyCallback  callback,
+                         gpointer             user_data)
+{
+	GTask *task;
+
+	task = g_task_new (catalog, cancellable, callback, user_data);
+	g_task_set_source_tag (task, applauncher_catalog_load_async);
+	g_task_set_task_data (task, GINT_TO_POINTER (use_snapshot), NULL);
+	g_task_run_in_thread (task, catalog_load_thread);
+	g_object_unref (task);
+}
+
+static gboolean
+catalog_entry_equal (ApplauncherCatalogEntry *a,
+                     ApplauncherCatalogEntry *b)
+{
+	return (g_strcmp0 (a->desktop_id, b->desktop_id) == 0 &&
+            g_strcmp0 (a->path, b->path) == 0 &&
+            g_strcmp0 (a->name, b->name) == 0 &&
+            g_strcmp0 (a->untranslated_name, b->untranslated_name) == 0 &&
+            g_strcmp0 (a->description, b->description) == 0 &&
+            g_strcmp0 (a->generic_name, b->generic_name) == 0 &&
+            g_strcmp0 (a->keywords, b->keywords) == 0 &&
+            g_strcmp0 (a->categories, b->categories) == 0 &&
+            g_strcmp0 (a->exec, b->exec) == 0 &&
+            g_strcmp0 (a->try_exec, b->try_exec) == 0 &&
+            g_strcmp0 (a->icon, b->icon) == 0);
+}
+
+/* 디렉토리 목록(이름, 아이콘, 경로)이 같으면 TRUE 를 반환한다.
+ * same_members 에는 각 디렉토리의 항목까지 같은지를 돌려준다. */
+static gboolean
+catalog_directories_equal (GPtrArray *a,
+                           GPtrArray *b,
+                           gboolean  *same_members)
+{
+	guint i;
+
+	*same_members = FALSE;
+
+	if (!a || !b || a->len != b->len)
+		return FALSE;
+
+	*same_members = TRUE;
+
+	for (i = 0; i < a->len; i++) {
+		ApplauncherCatalogDirectory *da = g_ptr_array_index (a, i);
+		ApplauncherCatalogDirectory *db = g_ptr_array_index (b, i);
+
+		if (g_strcmp0 (da->name, db->name) != 0 ||
+            g_strcmp0 (da->icon, db->icon) != 0 ||
+            g_strcmp0 (da->path, db->path) != 0) {
+			*same_members = FALSE;
+			return FALSE;
+		}
+
+		if (da->members->len != db->members->len ||
+            memcmp (da->members->data, db->members->data, da->members->len * sizeof (guint)) != 0)
+			*same_members = FALSE;
+	}
+
+	return TRUE;
+}
+
+/* 항목의 블랙리스트 상태를 갱신하고, 바뀐 항목이 있으면 TRUE 를 반환한다. */
+static gboolean
+catalog_update_blocked (ApplauncherCatalog *catalog)
+{
+	guint i;
+	gboolean changed = FALSE;
+	ApplauncherCatalogPrivate *priv = catalog->priv;
+
+	applauncher_bitset_resize (priv->visible, priv->entries ? priv->entries->len : 0);
+
+	for (i = 0; priv->entries && i < priv->entries->len; i++) {
+		ApplauncherCatalogEntry *entry = g_ptr_array_index (priv->entries, i);
+		gboolean blocked = applauncher_blacklist_is_blocked (priv->blacklist, entry);
+
+		if (entry->blocked != blocked) {
+			entry->blocked = blocked;
+			changed = TRUE;
+		}
+
+		if (!blocked)
+			applauncher_bitset_add (priv->visible, i);
+	}
+
+	return changed;
+}
+
+static void tree_changed_cb (GMenuTree *tree, gpointer data);
+
+/* 새로 읽은 카탈로그를 기존 카탈로그와 desktop id 로 비교해서 적용한다.
+ * 바뀌지 않은 항목은 기존 포인터를 그대로 유지하고, 아무것도 바뀌지 않았으면
+ * 윈도우가 가진 목록과 색인이 계속 유효하도록 기존 목록을 그대로 둔다. */
+static void
+catalog_apply_data (ApplauncherCatalog *catalog,
+                    CatalogData        *data)
+{
+	guint i, n_added = 0, n_changed = 0, n_removed = 0;
+	gboolean first, dirs_changed, same_members, reordered = FALSE;
+	GHashTable *old_by_id = NULL;
+	GPtrArray *old_entries, *old_dirs, *matches;
+	ApplauncherSearchIndex *old_index;
+	ApplauncherCatalogPrivate *priv = catalog->priv;
+
+	first = !priv->loaded;
+	old_entries = priv->entries;
+	old_dirs = priv->dirs;
+
+	/* 목록이 바뀌지 않았더라도 새로 읽은 메뉴 트리로 변경을 감시한다. */
+	if (data->tree) {
+		if (priv->tree) {
+			g_signal_handlers_disconnect_by_func (priv->tree, tree_changed_cb, catalog);
+			g_object_unref (priv->tree);
+		}
+		priv->tree = g_steal_pointer (&data->tree);
+		g_signal_connect (priv->tree, "changed", G_CALLBACK (tree_changed_cb), catalog);
+	}
+
+	if (old_entries) {
+		old_by_id = g_hash_table_new (g_str_hash, g_str_equal);
+		for (i = 0; i < old_entries->len; i++) {
+			ApplauncherCatalogEntry *old = g_ptr_array_index (old_entries, i);
+			g_hash_table_insert (old_by_id, old->desktop_id, old);
+		}
+	}
+
+	/* 새 항목마다 그대로 다시 쓸 수 있는 기존 항목을 찾아 둔다. */
+	matches = g_ptr_array_sized_new (data->entries->len);
+	for (i = 0; i < data->entries->len; i++) {
+		ApplauncherCatalogEntry *entry = g_ptr_array_index (data->entries, i);
+		ApplauncherCatalogEntry *old;
+
+		old = old_by_id ? g_hash_table_lookup (old_by_id, entry->desktop_id) : NULL;
+		if (old) {
+			g_hash_table_remove (old_by_id, entry->desktop_id);
+			if (!catalog_entry_equal (old, entry)) {
+				n_changed++;
+				old = NULL;
+			} else if (old->index != entry->index) {
+				reordered = TRUE;
+			}
+		} else {
+			n_added++;
+		}
+
+		g_ptr_array_add (matches, old);
+	}
+
+	if (old_by_id) {
+		n_removed = g_hash_table_size (old_by_id);
+		g_hash_table_destroy (old_by_id);
+	}
+
+	dirs_changed = !catalog_directories_equal (old_dirs, data->dirs, &same_members);
+
+	if (!first && !dirs_changed && same_members && !reordered &&
+        !n_added && !n_removed && !n_changed) {
+		/* 새로 읽은 목록은 호출한 쪽에서 해제된다. 블랙리스트 상태는 따로 바뀌었을 수 있다. */
+		g_ptr_array_unref (matches);
+		if (catalog_update_blocked (catalog)) {
+			priv->generation++;
+			g_signal_emit (catalog, signals[CHANGED], 0, FALSE);
+		}
+		return;
+	}
+
+	for (i = 0; i < data->entries->len; i++) {
+		ApplauncherCatalogEntry *entry = g_ptr_array_index (data->entries, i);
+		ApplauncherCatalogEntry *old = g_ptr_array_index (matches, i);
+
+		if (!old)
+			continue;
+
+		/* 새 검색 색인과 같은 키를 쓰도록 새 항목의 키로 바꿔 둔다. */
+		applauncher_search_key_unref (old->search_key);
+		old->search_key = g_steal_pointer (&entry->search_key);
+
+		g_ptr_array_index (old_entries, old->index) = NULL;
+		old->index = entry->index;
+		g_ptr_array_index (data->entries, i) = old;
+		applauncher_catalog_entry_free (entry);
+	}
+	g_ptr_array_unref (matches);
+
+	old_index = priv->index;
+
+	priv->entries = g_steal_pointer (&data->entries);
+	priv->dirs = g_steal_pointer (&data->dirs);
+	priv->index = g_steal_pointer (&data->index);
+	priv->loaded = TRUE;
+
+	catalog_update_blocked (catalog);
+
+	g_debug ("Catalog changed: %u added, %u removed, %u changed", n_added, n_removed, n_changed);
+
+	priv->generation++;
+	g_signal_emit (catalog, signals[CHANGED], 0, first || dirs_changed);
+
+	/* 시그널 핸들러에서 이전 항목에 대한 참조를 정리한 뒤에 해제한다. */
+	if (old_entries)
+		g_ptr_array_unref (old_entries);
+	if (old_dirs)
+		g_ptr_array_unref (old_dirs);
+	applauncher_search_index_unref (old_index);
+}
+
+static void catalog_start_load (ApplauncherCatalog *catalog, gboolean use_snapshot);
+static void catalog_queue_reload (ApplauncherCatalog *catalog);
+
+static void
+catalog_reload_cb (GObject      *source_object,
+                   GAsyncResult *result,
+                   gpointer      data)
+{
+	GError *error = NULL;
+	ApplauncherCatalog *catalog = APPLAUNCHER_CATALOG (source_object);
+	ApplauncherCatalogPrivate *priv = catalog->priv;
+
+	priv->loading = FALSE;
+
+	if (!applauncher_catalog_load_finish (catalog, result, &error)) {
+		if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+			g_error_free (error);
+			return;
+		}
+		g_warning ("Failed to load applications menu: %s", error->message);
+		g_error_free (error);
+	} else if (!priv->tree && !priv->reload_pending) {
+		/* 스냅샷에서 읽은 경우 메뉴 트리의 변경을 감시할 수 있도록 잠시 뒤 트리를 읽는다.
+		 * 첫 팝업과 겹치지 않도록 미루며, 바뀐 것이 없으면 기존 목록을 그대로 둔다. */
+		catalog_queue_reload (catalog);
+	}
+
+	if (priv->reload_pending) {
+		priv->reload_pending = FALSE;
+		catalog_start_load (catalog, FALSE);
+	}
+}
+
+static void
+catalog_start_load (ApplauncherCatalog *catalog,
+                    gboolean            use_snapshot)
+{
+	ApplauncherCatalogPrivate *priv = catalog->priv;
+
+	if (g_cancellable_is_cancelled (priv->cancellable))
+		return;
+
+	/* 읽는 도중에 들어온 변경은 끝난 뒤에 한 번만 다시 읽는다. */
+	if (priv->loading) {
+		priv->reload_pending = TRUE;
+		return;
+	}
+
+	priv->loading = TRUE;
+
+	catalog_load_async_full (catalog, use_snapshot, priv->cancellable, catalog_reload_cb, NULL);
+}
+
+static gboolean
+reload_timeout_cb (gpointer data)
+{
+	ApplauncherCatalog *catalog = APPLAUNCHER_CATALOG (data);
+
+	catalog->priv->reload_timeout_id = 0;
+
+	/* 데스크톱 파일과 함께 TryExec 프로그램이 설치되었을 수 있다. */
+	applauncher_blacklist_revalidate_missing (catalog->priv->blacklist);
+
+	catalog_start_load (catalog, FALSE);
+
+	return FALSE;
+}
+
+/* 패키지를 설치하면 여러 데스크톱 파일이 연달아 바뀌므로
+ * 마지막 변경 후 잠시 기다렸다가 한 번만 다시 읽는다. */
+static void
+catalog_queue_reload (ApplauncherCatalog *catalog)
+{
+	ApplauncherCatalogPrivate *priv = catalog->priv;
+
+	if (priv->reload_timeout_id != 0)
+		g_source_remove (priv->reload_timeout_id);
+
+	priv->reload_timeout_id = g_timeout_add (RELOAD_DELAY, reload_timeout_cb, catalog);
+}
+
+static void
+tree_changed_cb (GMenuTree *tree,
+                 gpointer   data)
+{
+	catalog_queue_reload (APPLAUNCHER_CATALOG (data));
+}
+
+static void
+app_info_monitor_changed_cb (GAppInfoMonitor *monitor,
+                             gpointer         data)
+{
+	catalog_queue_reload (APPLAUNCHER_CATALOG (data));
+}
+
+static void
+blacklist_changed_cb (ApplauncherBlacklist *blacklist,
+                      gpointer              data)
+{
+	ApplauncherCatalog *catalog = APPLAUNCHER_CATALOG (data);
+
+	/* 메뉴 트리를 다시 읽지 않고 메모리에서 항목만 걸러낸다. */
+	if (catalog_update_blocked (catalog)) {
+		catalog->priv->generation++;
+		g_signal_emit (catalog, signals[CHANGED], 0, FALSE);
+	}
+}
+
+static void
+applauncher_catalog_clear (ApplauncherCatalog *catalog)
+{
+	ApplauncherCatalogPrivate *priv = catalog->priv;
+
+	g_clear_pointer (&priv->dirs, g_ptr_array_unref);
+	g_clear_pointer (&priv->entries, g_ptr_array_unref);
+	g_clear_pointer (&priv->index, applauncher_search_index_unref);
+
+	if (priv->tree) {
+		g_signal_handlers_disconnect_by_func (priv->tree, tree_changed_cb, catalog);
+		g_clear_object (&priv->tree);
+	}
+}
+
+static void
+applauncher_catalog_dispose (GObject *object)
+{
+	ApplauncherCatalog *catalog = APPLAUNCHER_CATALOG (object);
+	ApplauncherCatalogPrivate *priv = catalog->priv;
+
+	/* 진행 중인 작업이 카탈로그의 참조를 가지고 있으므로 결과를 버리게 한다. */
+	g_cancellable_cancel (priv->cancellable);
+
+	if (priv->reload_timeout_id != 0) {
+		g_source_remove (priv->reload_timeout_id);
+		priv->reload_timeout_id = 0;
+	}
+
+	if (priv->tree)
+		g_signal_handlers_disconnect_by_func (priv->tree, tree_changed_cb, catalog);
+
+	if (priv->monitor) {
+		g_signal_handlers_disconnect_by_func (priv->monitor, app_info_monitor_changed_cb, catalog);
+		g_clear_object (&priv->monitor);
+	}
+
+	if (priv->blacklist) {
+		g_signal_handlers_disconnect_by_func (priv->blacklist, blacklist_changed_cb, catalog);
+		g_clear_object (&priv->blacklist);
+	}
+
+	G_OBJECT_CLASS (applauncher_catalog_parent_class)->dispose (object);
+}
+
+static void
+applauncher_catalog_finalize (GObject *object)
+{
+	ApplauncherCatalog *catalog = APPLAUNCHER_CATALOG (object);
+
+	applauncher_catalog_clear (catalog);
+	applauncher_bitset_free (catalog->priv->visible);
+	g_object_unref (catalog->priv->cancellable);
+
+	G_OBJECT_CLASS (applauncher_catalog_parent_class)->finalize (object);
+}
+
+static void
+applauncher_catalog_init (ApplauncherCatalog *catalog)
+{
+	ApplauncherCatalogPrivate *priv;
+
+	priv = catalog->priv = applauncher_catalog_get_instance_private (catalog);
+
+	priv->tree = NULL;
+	priv->dirs = NULL;
+	priv->entries = NULL;
+	priv->visible = applauncher_bitset_new (0);
+	priv->index = NULL;
+	priv->generation = 0;
+	priv->reload_timeout_id = 0;
+	priv->cancellable = g_cancellable_new ();
+	priv->loaded = FALSE;
+	priv->loading = FALSE;
+	priv->reload_pending = FALSE;
+
+	priv->monitor = g_app_info_monitor_get ();
+	g_signal_connect (priv->monitor, "changed",
+                      G_CALLBACK (app_info_monitor_changed_cb), catalog);
+
+	priv->blacklist = applauncher_blacklist_new ();
+	g_signal_connect (priv->blacklist, "changed",
+                      G_CALLBACK (blacklist_changed_cb), catalog);
+}
+
+static void
+applauncher_catalog_class_init (ApplauncherCatalogClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+	object_class->dispose = applauncher_catalog_dispose;
+	object_class->finalize = applauncher_catalog_finalize;
+
+	signals[CHANGED] = g_signal_new ("changed",
+                                     APPLAUNCHER_TYPE_CATALOG,
+                                     G_SIGNAL_RUN_LAST,
+                                     G_STRUCT_OFFSET (ApplauncherCatalogClass,
+                                     changed),
+                                     NULL, NULL,
+                                     g_cclosure_marshal_VOID__BOOLEAN,
+                                     G_TYPE_NONE, 1,
+                                     G_TYPE_BOOLEAN);
+}
+
+ApplauncherCatalog *
+applauncher_catalog_new (void)
+{
+	return g_object_new (APPLAUNCHER_TYPE_CATALOG, NULL);
+}
+
+void
+applauncher_catalog_load_async (ApplauncherCatalog  *catalog,
+                                GCancellable        *cancellable,
+                                GAsyncReadyCallback  callback,
+                                gpointer             user_data)
+{
+	g_return_if_fail (APPLAUNCHER_IS_CATALOG (catalog));
+
+	catalog_load_async_full (catalog, TRUE, cancellable, callback, user_data);
+}
+
+gboolean
+applauncher_catalog_load_finish (ApplauncherCatalog  *catalog,
+                                 GAsyncResult        *result,
+                                 GError             **error)
+{
+	CatalogData *data;
+
+	g_return_val_if_fail (APPLAUNCHER_IS_CATALOG (catalog), FALSE);
+	g_return_val_if_fail (g_task_is_valid (result, catalog), FALSE);
+
+	data = g_task_propagate_pointer (G_TASK (result), error);
+	if (!data)
+		return FALSE;
+
+	catalog_apply_data (catalog, data);
+	catalog_data_free (data);
+
+	return TRUE;
+}
+
+/* 카탈로그를 다시 읽는다. 읽는 중이면 끝난 뒤에 한 번 더 읽는다.
+ * 처음 읽을 때는 스냅샷을 사용한다. */
+void
+applauncher_catalog_reload (ApplauncherCatalog *catalog)
+{
+	g_return_if_fail (APPLAUNCHER_IS_CATALOG (catalog));
+
+	catalog_start_load (catalog, !catalog->priv->loaded);
+}
+
+gboolean
+applauncher_catalog_is_loaded (ApplauncherCatalog *catalog)
+{
+	g_return_val_if_fail (APPLAUNCHER_IS_CATALOG (catalog), FALSE);
+
+	return catalog->priv->loaded;
+}
+
+guint
+applauncher_catalog_get_generation (ApplauncherCatalog *catalog)
+{
+	g_return_val_if_fail (APPLAUNCHER_IS_CATALOG (catalog), 0);
+
+	return catalog->priv->generation;
+}
+
+GMenuTree *
+applauncher_catalog_get_tree (ApplauncherCatalog *catalog)
+{
+	g_return_val_if_fail (APPLAUNCHER_IS_CATALOG (catalog), NULL);
+
+	return catalog->priv->tree;
+}
+
+GPtrArray *
+applauncher_catalog_get_entries (ApplauncherCatalog *catalog)
+{
+	g_return_val_if_fail (APPLAUNCHER_IS_CATALOG (catalog), NULL);
+
+	return catalog->priv->entries;
+}
+
+GPtrArray *
+applauncher_catalog_get_directories (ApplauncherCatalog *catalog)
+{
+	g_return_val_if_fail (APPLAUNCHER_IS_CATALOG (catalog), NULL);
+
+	return catalog->priv->dirs;
+}
+
+ApplauncherSearchIndex *
+applauncher_catalog_get_search_index (ApplauncherCatalog *catalog)
+{
+	g_return_val_if_fail (APPLAUNCHER_IS_CATALOG (catalog), NULL);
+
+	return catalog->priv->index;
+}
+
+const ApplauncherBitset *
+applauncher_catalog_get_visible (ApplauncherCatalog *catalog)
+{
+	g_return_val_if_fail (APPLAUNCHER_IS_CATALOG (catalog), NULL);
+
+	return catalog->priv->visible;
+}
+
+ApplauncherCatalogEntry *
+applauncher_catalog_entry_new (void)
+{
+	return g_slice_new0 (ApplauncherCatalogEntry);
+}
+
+void
+applauncher_catalog_entry_free (ApplauncherCatalogEntry *entry)
+{
+	if (!entry)
+		return;
+
+	g_free (entry->desktop_id);
+	g_free (entry->path);
+	g_free (entry->name);
+	g_free (entry->untranslated_name);
+	g_free (entry->description);
+	g_free (entry->generic_name);
+	g_free (entry->keywords);
+	g_free (entry->categories);
+	g_free (entry->exec);
+	g_free (entry->try_exec);
+	g_free (entry->icon);
+	applauncher_search_key_unref (entry->search_key);
+	g_clear_object (&entry->gicon);
+
+	g_slice_free (ApplauncherCatalogEntry, entry);
+}
+
+GIcon *
+applauncher_catalog_entry_get_icon (ApplauncherCatalogEntry *entry)
+{
+	g_return_val_if_fail (entry != NULL, NULL);
+
+	if (!entry->gicon && entry->icon)
+		entry->gicon = g_icon_new_for_string (entry->icon, NULL);
+
+	return entry->gicon;
+}
+
+ApplauncherCatalogDirectory *
+applauncher_catalog_directory_new (void)
+{
+	ApplauncherCatalogDirectory *directory;
+
+	directory = g_slice_new0 (ApplauncherCatalogDirectory);
+	directory->members = g_array_new (FALSE, FALSE, sizeof (guint));
+	directory->member_set = applauncher_bitset_new (0);
+
+	return directory;
+}
+
+void
+applauncher_catalog_directory_free (ApplauncherCatalogDirectory *directory)
+{
+	if (!directory)
+		return;
+
+	g_free (directory->name);
+	g_free (directory->icon);
+	g_free (directory->path);
+	g_array_unref (directory->members);
+	applauncher_bitset_free (directory->member_set);
+
+	g_slice_free (ApplauncherCatalogDirectory, directory);
+}
@@ -0,0 +1,139 @@
+/*
+ *  Copyright (C) 2018-2021 Gooroom <gooroom@gooroom.kr>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#ifndef __APPLAUNCHER_CATALOG_H__
+#define __APPLAUNCHER_CATALOG_H__
+
+#include <gio/gio.h>
+
+#include <gmenu-tree.h>
+
+#include "applauncher-bitset.h"
+#include "applauncher-search.h"
+
+G_BEGIN_DECLS
+
+#define APPLAUNCHER_TYPE_CATALOG            (applauncher_catalog_get_type ())
+#define APPLAUNCHER_CATALOG(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), APPLAUNCHER_TYPE_CATALOG, ApplauncherCatalog))
+#define APPLAUNCHER_CATALOG_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass), APPLAUNCHER_TYPE_CATALOG, ApplauncherCatalogClass))
+#define APPLAUNCHER_IS_CATALOG(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), APPLAUNCHER_TYPE_CATALOG))
+#define APPLAUNCHER_IS_CATALOG_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), APPLAUNCHER_TYPE_CATALOG))
+#define APPLAUNCHER_CATALOG_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj), APPLAUNCHER_TYPE_CATALOG, ApplauncherCatalogClass))
+
+typedef struct _ApplauncherCatalogPrivate   ApplauncherCatalogPrivate;
+typedef struct _ApplauncherCatalogClass     ApplauncherCatalogClass;
+typedef struct _ApplauncherCatalog          ApplauncherCatalog;
+typedef struct _ApplauncherCatalogEntry     ApplauncherCatalogEntry;
+typedef struct _ApplauncherCatalogDirectory ApplauncherCatalogDirectory;
+
+struct _ApplauncherCatalogEntry
+{
+	gchar *desktop_id;
+	gchar *path;
+	gchar *name;              /* 현재 로케일의 이름 */
+	gchar *untranslated_name;
+	gchar *description;
+	gchar *generic_name;
+	gchar *keywords;          /* ';' 로 구분된 현재 로케일의 키워드 */
+	gchar *categories;        /* 데스크톱 파일의 Categories 값 */
+	gchar *exec;
+	gchar *try_exec;
+	gchar *icon;              /* g_icon_to_string () */
+
+	guint  index;             /* 카탈로그 안에서의 순서 */
+	guint  name_hash;         /* g_str_hash (name), 이름 중복 제거에 사용 */
+	ApplauncherSearchKey *search_key;
+
+	/* 메인 스레드에서만 사용 */
+	GIcon   *gicon;
+	gboolean blocked;         /* 블랙리스트 처리되어 보이지 않는 항목 */
+	gint     search_score;    /* 마지막 검색에서의 점수 */
+	gdouble  launch_score;    /* 마지막 검색 때의 실행 기록 점수, 같은 점수의 순위를 정한다 */
+};
+
+struct _ApplauncherCatalogDirectory
+{
+	gchar  *name;
+	gchar  *icon;
+	gchar  *path;             /* 루트 디렉토리는 NULL */
+
+	GArray *members;          /* 정렬된 항목 인덱스 (guint) */
+	ApplauncherBitset *member_set; /* members 와 같은 내용의 비트셋 */
+};
+
+struct _ApplauncherCatalogClass
+{
+	GObjectClass __parent_class__;
+
+	/*< signals >*/
+	void (*changed)(ApplauncherCatalog *catalog, gboolean directories_changed);
+};
+
+struct _ApplauncherCatalog
+{
+	GObject __parent__;
+
+	ApplauncherCatalogPrivate *priv;
+};
+
+
+GType               applauncher_catalog_get_type                   (void) G_GNUC_CONST;
+
+ApplauncherCatalog *applauncher_catalog_new                        (void);
+
+void                applauncher_catalog_load_async                 (ApplauncherCatalog  *catalog,
+                                                                    GCancellable        *cancellable,
+                                                                    GAsyncReadyCallback  callback,
+                                                                    gpointer             user_data);
+
+gboolean            applauncher_catalog_load_finish                (ApplauncherCatalog  *catalog,
+                                                                    GAsyncResult        *result,
+                                                                    GError             **error);
+
+void                applauncher_catalog_reload                     (ApplauncherCatalog  *catalog);
+
+gboolean            applauncher_catalog_is_loaded                  (ApplauncherCatalog  *catalog);
+
+guint               applauncher_catalog_get_generation             (ApplauncherCatalog  *catalog);
+
+GMenuTree          *applauncher_catalog_get_tree                   (ApplauncherCatalog  *catalog);
+
+GPtrArray          *applauncher_catalog_get_entries                (ApplauncherCatalog  *catalog);
+
+GPtrArray          *applauncher_catalog_get_directories            (ApplauncherCatalog  *catalog);
+
+const ApplauncherBitset *applauncher_catalog_get_visible           (ApplauncherCatalog  *catalog);
+
+/* 다른 스레드에서 쓰려면 applauncher_search_index_ref () 로 참조를 가져야 한다. */
+ApplauncherSearchIndex *applauncher_catalog_get_search_index       (ApplauncherCatalog  *catalog);
+
+
+ApplauncherCatalogEntry     *applauncher_catalog_entry_new         (void);
+
+void                         applauncher_catalog_entry_free        (ApplauncherCatalogEntry *entry);
+
+GIcon                       *applauncher_catalog_entry_get_icon    (ApplauncherCatalogEntry *entry);
+
+ApplauncherCatalogDirectory *applauncher_catalog_directory_new     (void);
+
+void                         applauncher_catalog_directory_free    (ApplauncherCatalogDirectory *directory);
+
+G_END_DECLS
+
+#endif /* !__APPLAUNCHER_CATALOG_H__ */
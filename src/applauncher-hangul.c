@@ -0,0 +1,167 @@
+/*
+ *  Copyright (C) 2018-2021 Gooroom <gooroom@gooroom.kr>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string.h>
+
+#include <glib.h>
+
+#include "applauncher-hangul.h"
+
+/*
+ * 검색 키와 검색어는 NFKD 로 정규화되어 있으므로 한글 음절은 조합형 자모
+ * (초성 U+1100, 중성 U+1161, 종성 U+11A8 부터)로 풀려 있고, 호환 자모
+ * (ㄱ, ㅏ 등)는 초성이나 중성 자모로 바뀌어 있다.
+ */
+
+#define LEADING_FIRST  0x1100
+#define LEADING_LAST   0x1112
+#define VOWEL_FIRST    0x1161
+#define VOWEL_LAST     0x1175
+#define TRAILING_FIRST 0x11a8
+#define TRAILING_LAST  0x11c2
+
+#define IS_LEADING(c)  ((c) >= LEADING_FIRST && (c) <= LEADING_LAST)
+#define IS_VOWEL(c)    ((c) >= VOWEL_FIRST && (c) <= VOWEL_LAST)
+#define IS_TRAILING(c) ((c) >= TRAILING_FIRST && (c) <= TRAILING_LAST)
+
+/* 종성을 다음 음절의 초성으로 옮길 때의 모양.
+ * 겹받침은 앞 자음(종성)이 남고 뒤 자음이 초성이 된다. */
+static const gunichar trailing_split[TRAILING_LAST - TRAILING_FIRST + 1][2] = {
+	{ 0,      0x1100 }, /* ㄱ */
+	{ 0,      0x1101 }, /* ㄲ */
+	{ 0x11a8, 0x1109 }, /* ㄳ */
+	{ 0,      0x1102 }, /* ㄴ */
+	{ 0x11ab, 0x110c }, /* ㄵ */
+	{ 0x11ab, 0x1112 }, /* ㄶ */
+	{ 0,      0x1103 }, /* ㄷ */
+	{ 0,      0x1105 }, /* ㄹ */
+	{ 0x11af, 0x1100 }, /* ㄺ */
+	{ 0x11af, 0x1106 }, /* ㄻ */
+	{ 0x11af, 0x1107 }, /* ㄼ */
+	{ 0x11af, 0x1109 }, /* ㄽ */
+	{ 0x11af, 0x1110 }, /* ㄾ */
+	{ 0x11af, 0x1111 }, /* ㄿ */
+	{ 0x11af, 0x1112 }, /* ㅀ */
+	{ 0,      0x1106 }, /* ㅁ */
+	{ 0,      0x1107 }, /* ㅂ */
+	{ 0x11b8, 0x1109 }, /* ㅄ */
+	{ 0,      0x1109 }, /* ㅅ */
+	{ 0,      0x110a }, /* ㅆ */
+	{ 0,      0x110b }, /* ㅇ */
+	{ 0,      0x110c }, /* ㅈ */
+	{ 0,      0x110e }, /* ㅊ */
+	{ 0,      0x110f }, /* ㅋ */
+	{ 0,      0x1110 }, /* ㅌ */
+	{ 0,      0x1111 }, /* ㅍ */
+	{ 0,      0x1112 }  /* ㅎ */
+};
+
+static gunichar
+trailing_to_leading (gunichar c)
+{
+	return trailing_split[c - TRAILING_FIRST][1];
+}
+
+/* 정규화된 이름에서 초성만 남긴 문자열을 돌려준다. 한글이 아닌 글자는 그대로 둔다.
+ * 한글 음절이 없으면 NULL 을 돌려준다. */
+gchar *
+applauncher_hangul_get_choseong (const gchar *normalized)
+{
+	GString *out;
+	const gchar *p;
+	gboolean has_hangul = FALSE;
+
+	if (!normalized)
+		return NULL;
+
+	out = g_string_sized_new (strlen (normalized));
+
+	for (p = normalized; *p; p = g_utf8_next_char (p)) {
+		gunichar c = g_utf8_get_char (p);
+
+		if (IS_VOWEL (c) || IS_TRAILING (c))
+			continue;
+
+		if (IS_LEADING (c))
+			has_hangul = TRUE;
+
+		g_string_append_unichar (out, c);
+	}
+
+	if (!has_hangul) {
+		g_string_free (out, TRUE);
+		return NULL;
+	}
+
+	return g_string_free (out, FALSE);
+}
+
+/* 입력기가 조합 중인 검색어를 이름과 비교할 수 있는 모양으로 바꾼다.
+ *
+ *  - 모음 없이 홀로 입력된 겹자음(ㄳ 등)은 초성 두 개로 푼다.
+ *  - 마지막 음절의 받침은 다음 음절의 초성이 될 수 있으므로 초성으로 옮긴다.
+ *    ("텟" -> "테ㅅ", "닭" -> "달ㄱ")
+ *
+ * 바꿀 것이 없으면 NULL 을 돌려준다. */
+gchar *
+applauncher_hangul_expand_query (const gchar *normalized)
+{
+	GString *out;
+	const gchar *p;
+	gunichar prev = 0;
+	gboolean changed = FALSE;
+
+	if (!normalized)
+		return NULL;
+
+	out = g_string_sized_new (strlen (normalized) + 6);
+
+	for (p = normalized; *p; p = g_utf8_next_char (p)) {
+		gunichar c = g_utf8_get_char (p);
+		gboolean last = (*g_utf8_next_char (p) == '\0');
+
+		if (IS_TRAILING (c) && (!IS_VOWEL (prev) || last)) {
+			const gunichar *split = trailing_split[c - TRAILING_FIRST];
+
+			if (split[0] != 0) {
+				if (IS_VOWEL (prev))
+					g_string_append_unichar (out, split[0]);
+				else
+					g_string_append_unichar (out, trailing_to_leading (split[0]));
+			}
+			g_string_append_unichar (out, split[1]);
+			changed = TRUE;
+		} else {
+			g_string_append_unichar (out, c);
+		}
+
+		prev = c;
+	}
+
+	if (!changed) {
+		g_string_free (out, TRUE);
+		return NULL;
+	}
+
+	return g_string_free (out, FALSE);
+}
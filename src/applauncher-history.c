@@ -0,0 +1,337 @@
+/*
+ *  Copyright (C) 2018-2021 Gooroom <gooroom@gooroom.kr>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include "applauncher-history.h"
+
+/*
+ * 실행 기록 파일 구조 (호스트 바이트 순서, 크기 고정)
+ *
+ *   HistoryHeader
+ *   HistorySlot x HISTORY_N_SLOTS
+ *
+ * 파일을 MAP_SHARED 로 매핑해서 실행할 때마다 해당 슬롯만 제자리에서 고친다.
+ * 슬롯이 모두 차면 현재 점수가 가장 낮은 슬롯을 다시 쓴다.
+ */
+
+#define HISTORY_MAGIC     0x48414c47 /* "GLAH" */
+#define HISTORY_VERSION   1
+#define HISTORY_N_SLOTS   128
+#define HISTORY_KEY_SIZE  256
+#define HISTORY_HALF_LIFE (7 * 24 * 60 * 60.0) /* 점수가 절반이 되는 시간(초) */
+
+typedef struct
+{
+	guint32 magic;
+	guint32 version;
+	guint32 n_slots;
+	guint32 reserved;
+} HistoryHeader;
+
+typedef struct
+{
+	gchar   desktop_id[HISTORY_KEY_SIZE]; /* NUL 로 끝나며, 빈 문자열이면 빈 슬롯 */
+	guint32 count;
+	guint32 reserved;
+	gint64  last_used;                    /* 마지막 실행 시각(초) */
+	gdouble score;                        /* last_used 시점의 점수 */
+} HistorySlot;
+
+#define HISTORY_FILE_SIZE (sizeof (HistoryHeader) + HISTORY_N_SLOTS * sizeof (HistorySlot))
+
+struct _ApplauncherHistory
+{
+	gint           fd;
+	gpointer       data;      /* 매핑한 파일, 실패하면 저장되지 않는 메모리 */
+	gboolean       mapped;
+	HistoryHeader *header;
+	HistorySlot   *slots;
+	GHashTable    *by_id;     /* slot->desktop_id -> slot */
+	guint          serial;    /* 기록할 때마다 증가 */
+};
+
+typedef struct
+{
+	HistorySlot *slot;
+	gdouble      score;
+} RankedSlot;
+
+
+static gint64
+history_now (void)
+{
+	return g_get_real_time () / G_USEC_PER_SEC;
+}
+
+static gdouble
+slot_score (const HistorySlot *slot,
+            gint64             now)
+{
+	/* 시계가 뒤로 간 경우에는 감쇠하지 않는다. */
+	gint64 elapsed = MAX (now - slot->last_used, 0);
+
+	return slot->score * exp2 (-(gdouble)elapsed / HISTORY_HALF_LIFE);
+}
+
+static gboolean
+history_map_file (ApplauncherHistory *history,
+                  const gchar        *path)
+{
+	gchar *dir;
+	GStatBuf buf;
+	gpointer data;
+
+	dir = g_path_get_dirname (path);
+	g_mkdir_with_parents (dir, 0700);
+	g_free (dir);
+
+	history->fd = g_open (path, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+	if (history->fd < 0) {
+		g_debug ("Failed to open launch history '%s': %s", path, g_strerror (errno));
+		return FALSE;
+	}
+
+	/* 크기가 다른 파일은 처음부터 다시 쓴다. */
+	if (fstat (history->fd, &buf) < 0 || buf.st_size != (goffset)HISTORY_FILE_SIZE) {
+		if (ftruncate (history->fd, 0) < 0 || ftruncate (history->fd, HISTORY_FILE_SIZE) < 0)
+			goto fail;
+	}
+
+	data = mmap (NULL, HISTORY_FILE_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, history->fd, 0);
+	if (data == MAP_FAILED)
+		goto fail;
+
+	history->data = data;
+	history->mapped = TRUE;
+
+	return TRUE;
+
+fail:
+	g_debug ("Failed to map launch history '%s': %s", path, g_strerror (errno));
+	close (history->fd);
+	history->fd = -1;
+
+	return FALSE;
+}
+
+gchar *
+applauncher_history_get_path (void)
+{
+	return g_build_filename (g_get_user_data_dir (), PACKAGE_NAME, "launch-history", NULL);
+}
+
+/* 파일을 쓸 수 없으면 이번 세션 동안만 메모리에 기록한다. */
+ApplauncherHistory *
+applauncher_history_new (const gchar *path)
+{
+	guint i;
+	ApplauncherHistory *history;
+
+	history = g_slice_new0 (ApplauncherHistory);
+	history->fd = -1;
+
+	if (!path || !history_map_file (history, path))
+		history->data = g_malloc0 (HISTORY_FILE_SIZE);
+
+	history->header = history->data;
+	history->slots = (HistorySlot *)((guchar *)history->data + sizeof (HistoryHeader));
+	history->by_id = g_hash_table_new (g_str_hash, g_str_equal);
+
+	if (history->header->magic != HISTORY_MAGIC ||
+        history->header->version != HISTORY_VERSION ||
+        history->header->n_slots != HISTORY_N_SLOTS) {
+		memset (history->data, 0, HISTORY_FILE_SIZE);
+		history->header->magic = HISTORY_MAGIC;
+		history->header->version = HISTORY_VERSION;
+		history->header->n_slots = HISTORY_N_SLOTS;
+	}
+
+	for (i = 0; i < HISTORY_N_SLOTS; i++) {
+		HistorySlot *slot = &history->slots[i];
+
+		slot->desktop_id[HISTORY_KEY_SIZE - 1] = '\0';
+		if (slot->desktop_id[0] == '\0')
+			continue;
+
+		/* 손상된 파일에서 같은 항목이 두 번 나오면 뒤의 것을 비운다. */
+		if (g_hash_table_contains (history->by_id, slot->desktop_id))
+			memset (slot, 0, sizeof (HistorySlot));
+		else
+			g_hash_table_insert (history->by_id, slot->desktop_id, slot);
+	}
+
+	return history;
+}
+
+void
+applauncher_history_free (ApplauncherHistory *history)
+{
+	if (!history)
+		return;
+
+	g_hash_table_destroy (history->by_id);
+
+	if (history->mapped) {
+		munmap (history->data, HISTORY_FILE_SIZE);
+		close (history->fd);
+	} else {
+		g_free (history->data);
+	}
+
+	g_slice_free (ApplauncherHistory, history);
+}
+
+void
+applauncher_history_record (ApplauncherHistory *history,
+                            const gchar        *desktop_id)
+{
+	guint i;
+	gint64 now;
+	HistorySlot *slot;
+
+	g_return_if_fail (history != NULL);
+
+	if (!desktop_id || *desktop_id == '\0' || strlen (desktop_id) >= HISTORY_KEY_SIZE)
+		return;
+
+	now = history_now ();
+	slot = g_hash_table_lookup (history->by_id, desktop_id);
+
+	if (!slot) {
+		gdouble lowest = G_MAXDOUBLE;
+
+		for (i = 0; i < HISTORY_N_SLOTS; i++) {
+			HistorySlot *s = &history->slots[i];
+			gdouble score;
+
+			if (s->desktop_id[0] == '\0') {
+				slot = s;
+				break;
+			}
+
+			score = slot_score (s, now);
+			if (score < lowest) {
+				lowest = score;
+				slot = s;
+			}
+		}
+
+		if (slot->desktop_id[0] != '\0')
+			g_hash_table_remove (history->by_id, slot->desktop_id);
+
+		memset (slot, 0, sizeof (HistorySlot));
+		g_strlcpy (slot->desktop_id, desktop_id, HISTORY_KEY_SIZE);
+		g_hash_table_insert (history->by_id, slot->desktop_id, slot);
+	}
+
+	slot->score = slot_score (slot, now) + 1.0;
+	slot->last_used = now;
+	slot->count++;
+
+	history->serial++;
+}
+
+/* 실행한 적이 없으면 0 이다. */
+gdouble
+applauncher_history_get_score (ApplauncherHistory *history,
+                               const gchar        *desktop_id)
+{
+	HistorySlot *slot;
+
+	g_return_val_if_fail (history != NULL, 0);
+
+	if (!desktop_id)
+		return 0;
+
+	slot = g_hash_table_lookup (history->by_id, desktop_id);
+
+	return slot ? slot_score (slot, history_now ()) : 0;
+}
+
+static gint
+compare_ranked_slots (gconstpointer a, gconstpointer b)
+{
+	const RankedSlot *ra = a;
+	const RankedSlot *rb = b;
+
+	if (ra->score != rb->score)
+		return (ra->score > rb->score) ? -1 : 1;
+
+	return (ra->slot < rb->slot) ? -1 : (ra->slot > rb->slot);
+}
+
+/* 점수가 높은 순서로 최대 max_items 개의 desktop id 를 돌려준다. */
+GPtrArray *
+applauncher_history_get_frequent (ApplauncherHistory *history,
+                                  guint               max_items)
+{
+	guint i;
+	gint64 now;
+	GArray *ranked;
+	GPtrArray *result;
+
+	g_return_val_if_fail (history != NULL, NULL);
+
+	now = history_now ();
+	ranked = g_array_new (FALSE, FALSE, sizeof (RankedSlot));
+
+	for (i = 0; i < HISTORY_N_SLOTS; i++) {
+		RankedSlot r;
+
+		if (history->slots[i].desktop_id[0] == '\0')
+			continue;
+
+		r.slot = &history->slots[i];
+		r.score = slot_score (r.slot, now);
+		g_array_append_val (ranked, r);
+	}
+
+	g_array_sort (ranked, compare_ranked_slots);
+
+	result = g_ptr_array_new_with_free_func (g_free);
+	for (i = 0; i < ranked->len && i < max_items; i++)
+		g_ptr_array_add (result, g_strdup (g_array_index (ranked, RankedSlot, i).slot->desktop_id));
+
+	g_array_unref (ranked);
+
+	return result;
+}
+
+/* 자주 쓰는 항목을 다시 구해야 하는지 판단하는 데 쓴다. */
+guint
+applauncher_history_get_serial (ApplauncherHistory *history)
+{
+	g_return_val_if_fail (history != NULL, 0);
+
+	return history->serial;
+}
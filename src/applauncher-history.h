@@ -0,0 +1,49 @@
+/*
+ *  Copyright (C) 2018-2021 Gooroom <gooroom@gooroom.kr>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#ifndef __APPLAUNCHER_HISTORY_H__
+#define __APPLAUNCHER_HISTORY_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* 응용 프로그램별 실행 횟수와 시간에 따라 감쇠하는 최근 사용 점수 */
+typedef struct _ApplauncherHistory ApplauncherHistory;
+
+gchar              *applauncher_history_get_path     (void);
+
+ApplauncherHistory *applauncher_history_new          (const gchar        *path);
+
+void                applauncher_history_free         (ApplauncherHistory *history);
+
+void                applauncher_history_record       (ApplauncherHistory *history,
+                                                      const gchar        *desktop_id);
+
+gdouble             applauncher_history_get_score    (ApplauncherHistory *history,
+                                                      const gchar        *desktop_id);
+
+GPtrArray          *applauncher_history_get_frequent (ApplauncherHistory *history,
+                                                      guint               max_items);
+
+guint               applauncher_history_get_serial   (ApplauncherHistory *history);
+
+G_END_DECLS
+
+#endif /* !__APPLAUNCHER_HISTORY_H__ */
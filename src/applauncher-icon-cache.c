@@ -0,0 +1,222 @@
+/*
+ *  Copyright (C) 2018-2021 Gooroom <gooroom@gooroom.kr>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <gtk/gtk.h>
+
+#include "applauncher-icon-cache.h"
+
+
+typedef struct
+{
+	GIcon           *icon;
+	gint             size;
+	gint             scale;
+	guint            hash;
+	cairo_surface_t *surface;   /* 찾지 못한 아이콘은 NULL 로 기억한다 */
+	gsize            bytes;
+} IconCacheItem;
+
+struct _ApplauncherIconCache
+{
+	GtkIconTheme *theme;
+	gsize         max_bytes;
+	gsize         total_bytes;
+	GHashTable   *items;   /* IconCacheItem -> GList (lru 의 링크) */
+	GQueue        lru;     /* IconCacheItem, 앞쪽이 가장 최근 */
+};
+
+
+static guint
+icon_cache_item_hash (gconstpointer key)
+{
+	return ((const IconCacheItem *)key)->hash;
+}
+
+static gboolean
+icon_cache_item_equal (gconstpointer a, gconstpointer b)
+{
+	const IconCacheItem *ia = a;
+	const IconCacheItem *ib = b;
+
+	return (ia->size == ib->size &&
+            ia->scale == ib->scale &&
+            g_icon_equal (ia->icon, ib->icon));
+}
+
+static void
+icon_cache_item_free (IconCacheItem *item)
+{
+	g_object_unref (item->icon);
+	if (item->surface)
+		cairo_surface_destroy (item->surface);
+	g_slice_free (IconCacheItem, item);
+}
+
+static void
+icon_cache_clear (ApplauncherIconCache *cache)
+{
+	g_hash_table_remove_all (cache->items);
+	g_queue_free_full (&cache->lru, (GDestroyNotify)icon_cache_item_free);
+	g_queue_init (&cache->lru);
+	cache->total_bytes = 0;
+}
+
+/* 방금 넣은 항목 하나는 남겨 둔다. */
+static void
+icon_cache_trim (ApplauncherIconCache *cache)
+{
+	while (cache->total_bytes > cache->max_bytes && cache->lru.length > 1) {
+		IconCacheItem *oldest = g_queue_pop_tail (&cache->lru);
+
+		g_hash_table_remove (cache->items, oldest);
+		cache->total_bytes -= oldest->bytes;
+		icon_cache_item_free (oldest);
+	}
+}
+
+static void
+icon_theme_changed_cb (GtkIconTheme *theme,
+                       gpointer      data)
+{
+	icon_cache_clear ((ApplauncherIconCache *)data);
+}
+
+static cairo_surface_t *
+icon_cache_load (ApplauncherIconCache *cache,
+                 GIcon                *icon,
+                 gint                  size,
+                 gint                  scale)
+{
+	GdkPixbuf *pixbuf;
+	GtkIconInfo *info;
+	GError *error = NULL;
+	cairo_surface_t *surface;
+
+	info = gtk_icon_theme_lookup_by_gicon_for_scale (cache->theme, icon, size, scale,
+                                                     GTK_ICON_LOOKUP_FORCE_SIZE);
+	if (!info)
+		return NULL;
+
+	pixbuf = gtk_icon_info_load_icon (info, &error);
+	g_object_unref (info);
+
+	if (!pixbuf) {
+		g_debug ("Failed to load icon: %s", error->message);
+		g_error_free (error);
+		return NULL;
+	}
+
+	surface = gdk_cairo_surface_create_from_pixbuf (pixbuf, scale, NULL);
+	g_object_unref (pixbuf);
+
+	return surface;
+}
+
+ApplauncherIconCache *
+applauncher_icon_cache_new (GtkIconTheme *theme,
+                            gsize         max_bytes)
+{
+	ApplauncherIconCache *cache;
+
+	g_return_val_if_fail (GTK_IS_ICON_THEME (theme), NULL);
+
+	cache = g_slice_new0 (ApplauncherIconCache);
+	cache->theme = g_object_ref (theme);
+	cache->max_bytes = max_bytes;
+	cache->items = g_hash_table_new (icon_cache_item_hash, icon_cache_item_equal);
+	g_queue_init (&cache->lru);
+
+	/* 테마가 바뀌면 같은 아이콘도 다른 파일에서 읽어야 한다. */
+	g_signal_connect (theme, "changed", G_CALLBACK (icon_theme_changed_cb), cache);
+
+	return cache;
+}
+
+void
+applauncher_icon_cache_free (ApplauncherIconCache *cache)
+{
+	if (!cache)
+		return;
+
+	g_signal_handlers_disconnect_by_func (cache->theme, icon_theme_changed_cb, cache);
+	g_object_unref (cache->theme);
+
+	icon_cache_clear (cache);
+	g_hash_table_destroy (cache->items);
+	g_slice_free (ApplauncherIconCache, cache);
+}
+
+void
+applauncher_icon_cache_set_max_size (ApplauncherIconCache *cache,
+                                     gsize                 max_bytes)
+{
+	g_return_if_fail (cache != NULL);
+
+	cache->max_bytes = max_bytes;
+	icon_cache_trim (cache);
+}
+
+/* 서피스의 참조를 돌려준다. 아이콘을 찾지 못하면 NULL 이다. */
+cairo_surface_t *
+applauncher_icon_cache_lookup (ApplauncherIconCache *cache,
+                               GIcon                *icon,
+                               gint                  size,
+                               gint                  scale)
+{
+	GList *link;
+	IconCacheItem key, *item;
+
+	g_return_val_if_fail (cache != NULL, NULL);
+	g_return_val_if_fail (G_IS_ICON (icon), NULL);
+
+	key.icon = icon;
+	key.size = size;
+	key.scale = scale;
+	key.hash = g_icon_hash (icon) ^ (guint)(size * 31 + scale);
+
+	link = g_hash_table_lookup (cache->items, &key);
+	if (link) {
+		g_queue_unlink (&cache->lru, link);
+		g_queue_push_head_link (&cache->lru, link);
+		item = link->data;
+	} else {
+		item = g_slice_new0 (IconCacheItem);
+		item->icon = g_object_ref (icon);
+		item->size = size;
+		item->scale = scale;
+		item->hash = key.hash;
+		item->surface = icon_cache_load (cache, icon, size, scale);
+		item->bytes = sizeof (IconCacheItem);
+		if (item->surface)
+			item->bytes += (gsize)cairo_image_surface_get_stride (item->surface) *
+                           cairo_image_surface_get_height (item->surface);
+
+		g_queue_push_head (&cache->lru, item);
+		g_hash_table_insert (cache->items, item, cache->lru.head);
+		cache->total_bytes += item->bytes;
+
+		icon_cache_trim (cache);
+	}
+
+	return item->surface ? cairo_surface_reference (item->surface) : NULL;
+}
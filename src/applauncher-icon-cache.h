@@ -0,0 +1,46 @@
+/*
+ *  Copyright (C) 2018-2021 Gooroom <gooroom@gooroom.kr>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#ifndef __APPLAUNCHER_ICON_CACHE_H__
+#define __APPLAUNCHER_ICON_CACHE_H__
+
+#include <gtk/gtk.h>
+
+G_BEGIN_DECLS
+
+/* 아이콘, 크기, 배율별로 그릴 준비가 된 아이콘 서피스를 보관하는 LRU 캐시.
+ * 팝업 윈도우보다 오래 유지되도록 애플릿이 소유한다. */
+typedef struct _ApplauncherIconCache ApplauncherIconCache;
+
+ApplauncherIconCache *applauncher_icon_cache_new          (GtkIconTheme         *theme,
+                                                           gsize                 max_bytes);
+
+void                  applauncher_icon_cache_free         (ApplauncherIconCache *cache);
+
+void                  applauncher_icon_cache_set_max_size (ApplauncherIconCache *cache,
+                                                           gsize                 max_bytes);
+
+cairo_surface_t      *applauncher_icon_cache_lookup       (ApplauncherIconCache *cache,
+                                                           GIcon                *icon,
+                                                           gint                  size,
+                                                           gint                  scale);
+
+G_END_DECLS
+
+#endif /* !__APPLAUNCHER_ICON_CACHE_H__ */
@@ -0,0 +1,169 @@
+/*
+ *  Copyright (C) 2018-2021 Gooroom <gooroom@gooroom.kr>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <glib.h>
+
+#include "applauncher-search-cache.h"
+
+
+typedef struct
+{
+	gchar  *key;
+	GArray *results;   /* ApplauncherSearchResult, 순위 순서가 아님 */
+} CacheItem;
+
+struct _ApplauncherSearchCache
+{
+	guint       max_queries;
+	guint       generation;
+	GHashTable *items;   /* key -> GList (lru 의 링크) */
+	GQueue      lru;     /* CacheItem, 앞쪽이 가장 최근 */
+};
+
+
+static void
+cache_item_free (CacheItem *item)
+{
+	g_free (item->key);
+	g_array_unref (item->results);
+	g_slice_free (CacheItem, item);
+}
+
+static gchar *
+cache_key (guint        directory,
+           const gchar *query)
+{
+	/* 검색어에는 '\n' 이 들어갈 수 없다. */
+	return g_strdup_printf ("%u\n%s", directory, query);
+}
+
+static void
+cache_clear (ApplauncherSearchCache *cache)
+{
+	g_hash_table_remove_all (cache->items);
+	g_queue_free_full (&cache->lru, (GDestroyNotify)cache_item_free);
+	g_queue_init (&cache->lru);
+}
+
+/* 카탈로그 세대가 바뀌면 항목 인덱스가 달라지므로 모두 버린다. */
+static void
+cache_check_generation (ApplauncherSearchCache *cache,
+                        guint                   generation)
+{
+	if (cache->generation == generation)
+		return;
+
+	cache_clear (cache);
+	cache->generation = generation;
+}
+
+ApplauncherSearchCache *
+applauncher_search_cache_new (guint max_queries)
+{
+	ApplauncherSearchCache *cache;
+
+	cache = g_slice_new0 (ApplauncherSearchCache);
+	cache->max_queries = MAX (max_queries, 1);
+	cache->items = g_hash_table_new (g_str_hash, g_str_equal);
+	g_queue_init (&cache->lru);
+
+	return cache;
+}
+
+void
+applauncher_search_cache_free (ApplauncherSearchCache *cache)
+{
+	if (!cache)
+		return;
+
+	cache_clear (cache);
+	g_hash_table_destroy (cache->items);
+	g_slice_free (ApplauncherSearchCache, cache);
+}
+
+/* 캐시된 결과의 참조를 돌려준다. 없으면 NULL 이다. */
+GArray *
+applauncher_search_cache_lookup (ApplauncherSearchCache *cache,
+                                 guint                   generation,
+                                 guint                   directory,
+                                 const gchar            *query)
+{
+	GList *link;
+	gchar *key;
+
+	g_return_val_if_fail (cache != NULL, NULL);
+	g_return_val_if_fail (query != NULL, NULL);
+
+	cache_check_generation (cache, generation);
+
+	key = cache_key (directory, query);
+	link = g_hash_table_lookup (cache->items, key);
+	g_free (key);
+
+	if (!link)
+		return NULL;
+
+	g_queue_unlink (&cache->lru, link);
+	g_queue_push_head_link (&cache->lru, link);
+
+	return g_array_ref (((CacheItem *)link->data)->results);
+}
+
+/* results 의 참조를 가진다. 가장 오래 쓰지 않은 검색어부터 버린다. */
+void
+applauncher_search_cache_insert (ApplauncherSearchCache *cache,
+                                 guint                   generation,
+                                 guint                   directory,
+                                 const gchar            *query,
+                                 GArray                 *results)
+{
+	GList *link;
+	CacheItem *item;
+
+	g_return_if_fail (cache != NULL);
+	g_return_if_fail (query != NULL);
+	g_return_if_fail (results != NULL);
+
+	cache_check_generation (cache, generation);
+
+	item = g_slice_new0 (CacheItem);
+	item->key = cache_key (directory, query);
+	item->results = g_array_ref (results);
+
+	link = g_hash_table_lookup (cache->items, item->key);
+	if (link) {
+		g_hash_table_remove (cache->items, item->key);
+		cache_item_free (link->data);
+		g_queue_delete_link (&cache->lru, link);
+	}
+
+	while (cache->lru.length >= cache->max_queries) {
+		CacheItem *oldest = g_queue_pop_tail (&cache->lru);
+
+		g_hash_table_remove (cache->items, oldest->key);
+		cache_item_free (oldest);
+	}
+
+	g_queue_push_head (&cache->lru, item);
+	g_hash_table_insert (cache->items, item->key, cache->lru.head);
+}
@@ -0,0 +1,55 @@
+/*
+ *  Copyright (C) 2018-2021 Gooroom <gooroom@gooroom.kr>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#ifndef __APPLAUNCHER_SEARCH_CACHE_H__
+#define __APPLAUNCHER_SEARCH_CACHE_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* 검색 결과 하나: 카탈로그 항목 인덱스와 점수 */
+typedef struct
+{
+	guint index;
+	gint  score;
+} ApplauncherSearchResult;
+
+/* 디렉토리와 정규화된 검색어별 검색 결과의 LRU 캐시.
+ * 팝업 윈도우보다 오래 유지되도록 애플릿이 소유한다. */
+typedef struct _ApplauncherSearchCache ApplauncherSearchCache;
+
+ApplauncherSearchCache *applauncher_search_cache_new    (guint                   max_queries);
+
+void                    applauncher_search_cache_free   (ApplauncherSearchCache *cache);
+
+GArray                 *applauncher_search_cache_lookup (ApplauncherSearchCache *cache,
+                                                         guint                   generation,
+                                                         guint                   directory,
+                                                         const gchar            *query);
+
+void                    applauncher_search_cache_insert (ApplauncherSearchCache *cache,
+                                                         guint                   generation,
+                                                         guint                   directory,
+                                                         const gchar            *query,
+                                                         GArray                 *results);
+
+G_END_DECLS
+
+#endif /* !__APPLAUNCHER_SEARCH_CACHE_H__ */
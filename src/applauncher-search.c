@@ -0,0 +1,578 @@
+/*
+ *  Copyright (C) 2018-2021 Gooroom <gooroom@gooroom.kr>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string.h>
+
+#include <glib.h>
+
+#include "applauncher-search.h"
+
+
+/* 1~3 바이트 n-gram 을 길이와 함께 32 비트 값으로 만든다. */
+#define GRAM(p, n) (((guint32)(n) << 24) |                                   \
+                    ((guint32)(guchar)(p)[0] << 16) |                         \
+                    ((n) > 1 ? (guint32)(guchar)(p)[1] << 8 : 0) |            \
+                    ((n) > 2 ? (guint32)(guchar)(p)[2] : 0))
+
+/* 정규화된 검색 키의 바이트 n-gram 역색인.
+ * 3 바이트 이상의 검색어는 trigram 목록의 교집합을 후보로 삼아 다시 확인하고,
+ * 더 짧은 검색어는 1, 2 바이트 n-gram 목록이 곧 결과가 된다. */
+struct _ApplauncherSearchIndex
+{
+	gint                   ref_count;
+	guint                  n_keys;
+	ApplauncherSearchKey **keys;      /* 참조를 가짐 */
+	GHashTable            *postings;  /* gram -> GArray (오름차순 guint) */
+};
+
+/* 점수: 일치한 필드의 가중치에 위치에 따른 보너스를 더한다.
+ * 이름에 대한 퍼지(부분 순서) 일치는 어떤 부분 문자열 일치보다도 낮도록
+ * 모든 필드 가중치는 MAX_POSITION_PENALTY + MAX_FUZZY_SCORE 보다 커야 한다. */
+#define MAX_POSITION_PENALTY 20
+#define PREFIX_BONUS         60
+#define EXACT_BONUS          100
+#define BOUNDARY_BONUS       30
+#define MAX_FUZZY_SCORE      (MAX_POSITION_PENALTY - 1)
+
+static const gint field_weights[APPLAUNCHER_SEARCH_N_FIELDS] = {
+	100, /* APPLAUNCHER_SEARCH_FIELD_NAME */
+	80,  /* APPLAUNCHER_SEARCH_FIELD_UNTRANSLATED_NAME */
+	60,  /* APPLAUNCHER_SEARCH_FIELD_GENERIC_NAME */
+	50,  /* APPLAUNCHER_SEARCH_FIELD_KEYWORDS */
+	40,  /* APPLAUNCHER_SEARCH_FIELD_EXEC */
+	70,  /* APPLAUNCHER_SEARCH_FIELD_CHOSEONG */
+	40,  /* APPLAUNCHER_SEARCH_FIELD_COMMENT */
+	45   /* APPLAUNCHER_SEARCH_FIELD_CATEGORIES */
+};
+
+/* 입력 중인 검색어의 이전 결과들. 검색어가 길어지면 맨 위 결과만 다시 확인하고,
+ * 지워지면 쌓아 둔 결과를 그대로 꺼내 쓴다. */
+#define MAX_SESSION_DEPTH 32
+
+typedef struct
+{
+	gchar             *query;
+	ApplauncherBitset *matches;
+} SessionState;
+
+struct _ApplauncherSearchSession
+{
+	const ApplauncherSearchIndex *index;
+	GPtrArray                    *stack;   /* SessionState, 마지막이 가장 최근 */
+};
+
+
+/* 대소문자를 무시하고 호환 분해(NFKD)한 문자열을 돌려준다.
+ * 검색 키와 검색어 모두 이 함수로 정규화해야 바이트 단위로 비교할 수 있다. */
+gchar *
+applauncher_search_normalize (const gchar *str)
+{
+	gchar *folded, *normalized;
+
+	if (!str || !g_utf8_validate (str, -1, NULL))
+		return NULL;
+
+	folded = g_utf8_casefold (str, -1);
+	normalized = g_utf8_normalize (folded, -1, G_NORMALIZE_ALL);
+	g_free (folded);
+
+	return normalized;
+}
+
+/* fields 는 ApplauncherSearchField 순서의 원본 문자열이며 NULL 일 수 있다.
+ * 키워드와 분류 필드의 ';' 는 필드 구분자와 같은 '\n' 으로 바꿔서 키워드끼리 이어서
+ * 일치하지 않도록 한다. 검색어에는 '\n' 이 들어갈 수 없다. */
+ApplauncherSearchKey *
+applauncher_search_key_new (const gchar *fields[APPLAUNCHER_SEARCH_N_FIELDS])
+{
+	guint i;
+	GString *text;
+	ApplauncherSearchKey *key;
+
+	key = g_slice_new0 (ApplauncherSearchKey);
+	key->ref_count = 1;
+	text = g_string_new (NULL);
+
+	for (i = 0; i < APPLAUNCHER_SEARCH_N_FIELDS; i++) {
+		gchar *normalized = applauncher_search_normalize (fields[i]);
+
+		if (i > 0)
+			g_string_append_c (text, '\n');
+
+		key->field_start[i] = text->len;
+
+		if (normalized) {
+			gsize start = text->len;
+
+			g_string_append (text, normalized);
+			if (i == APPLAUNCHER_SEARCH_FIELD_KEYWORDS ||
+			    i == APPLAUNCHER_SEARCH_FIELD_CATEGORIES) {
+				gsize j;
+				for (j = start; j < text->len; j++) {
+					if (text->str[j] == ';')
+						text->str[j] = '\n';
+				}
+			}
+			g_free (normalized);
+		}
+	}
+
+	key->field_start[APPLAUNCHER_SEARCH_N_FIELDS] = text->len;
+	key->text = g_string_free (text, FALSE);
+
+	return key;
+}
+
+ApplauncherSearchKey *
+applauncher_search_key_ref (ApplauncherSearchKey *key)
+{
+	g_return_val_if_fail (key != NULL, NULL);
+
+	g_atomic_int_inc (&key->ref_count);
+
+	return key;
+}
+
+void
+applauncher_search_key_unref (ApplauncherSearchKey *key)
+{
+	if (!key || !g_atomic_int_dec_and_test (&key->ref_count))
+		return;
+
+	g_free (key->text);
+	g_slice_free (ApplauncherSearchKey, key);
+}
+
+/* query 는 applauncher_search_normalize () 로 정규화된 검색어이다. */
+gboolean
+applauncher_search_key_match (const ApplauncherSearchKey *key,
+                              const gchar                *query)
+{
+	if (!key || !query || *query == '\0')
+		return FALSE;
+
+	return (strstr (key->text, query) != NULL);
+}
+
+static guint
+key_field_end (const ApplauncherSearchKey *key,
+               guint                       field)
+{
+	/* 마지막이 아닌 필드 뒤에는 구분자 '\n' 이 있다. */
+	if (field + 1 < APPLAUNCHER_SEARCH_N_FIELDS)
+		return key->field_start[field + 1] - 1;
+
+	return key->field_start[APPLAUNCHER_SEARCH_N_FIELDS];
+}
+
+static gboolean
+is_word_boundary (const gchar *text,
+                  const gchar *p)
+{
+	guchar prev;
+
+	if (p == text)
+		return TRUE;
+
+	prev = (guchar)p[-1];
+
+	return (prev < 0x80 && !g_ascii_isalnum (prev));
+}
+
+/* 검색어의 글자들이 이름에 순서대로 나타나면 일치한 것으로 본다. */
+static gint
+fuzzy_score (const gchar *text,
+             const gchar *start,
+             const gchar *end,
+             const gchar *query)
+{
+	gint score = MAX_FUZZY_SCORE / 2;
+	const gchar *p, *q, *last = NULL;
+
+	for (p = start, q = query; *q && p < end; p = g_utf8_next_char (p)) {
+		if (g_utf8_get_char (p) != g_utf8_get_char (q)) {
+			if (last)
+				score--;
+			continue;
+		}
+
+		if (last && g_utf8_next_char (last) == p)
+			score += 2;
+		if (p == start || is_word_boundary (text, p))
+			score += 2;
+
+		last = p;
+		q = g_utf8_next_char (q);
+	}
+
+	if (*q)
+		return -1;
+
+	return CLAMP (score, 1, MAX_FUZZY_SCORE);
+}
+
+/* 정규화된 query 의 점수를 돌려준다. 일치하지 않으면 -1 이다.
+ * fuzzy 가 TRUE 이면 부분 문자열로 일치하지 않을 때 이름에 대해서만 퍼지 일치를 시도한다. */
+gint
+applauncher_search_key_score (const ApplauncherSearchKey *key,
+                              const gchar                *query,
+                              gboolean                    fuzzy)
+{
+	guint field;
+	gsize qlen;
+	gint best = -1;
+
+	if (!key || !query || *query == '\0')
+		return -1;
+
+	qlen = strlen (query);
+
+	for (field = 0; field < APPLAUNCHER_SEARCH_N_FIELDS; field++) {
+		const gchar *start = key->text + key->field_start[field];
+		const gchar *end = key->text + key_field_end (key, field);
+		const gchar *p;
+
+		for (p = strstr (start, query); p && p + qlen <= end; p = strstr (p + 1, query)) {
+			gint score = field_weights[field];
+
+			if (p == start) {
+				score += PREFIX_BONUS;
+				if (p + qlen == end)
+					score += EXACT_BONUS;
+			} else if (is_word_boundary (key->text, p)) {
+				score += BOUNDARY_BONUS;
+			}
+
+			score -= MIN (p - start, MAX_POSITION_PENALTY);
+			best = MAX (best, score);
+		}
+	}
+
+	if (best < 0 && fuzzy) {
+		best = fuzzy_score (key->text,
+                            key->text + key->field_start[APPLAUNCHER_SEARCH_FIELD_NAME],
+                            key->text + key_field_end (key, APPLAUNCHER_SEARCH_FIELD_NAME),
+                            query);
+	}
+
+	return best;
+}
+
+static void
+index_add_gram (GHashTable *postings,
+                guint32     gram,
+                guint       key_index)
+{
+	GArray *list;
+
+	list = g_hash_table_lookup (postings, GUINT_TO_POINTER (gram));
+	if (!list) {
+		list = g_array_sized_new (FALSE, FALSE, sizeof (guint), 4);
+		g_hash_table_insert (postings, GUINT_TO_POINTER (gram), list);
+	}
+
+	/* 키를 순서대로 넣으므로 같은 키의 중복은 항상 마지막 원소이다. */
+	if (list->len == 0 || g_array_index (list, guint, list->len - 1) != key_index)
+		g_array_append_val (list, key_index);
+}
+
+/* keys 는 카탈로그 항목 인덱스 순서이며, 색인이 각 키의 참조를 가진다. */
+ApplauncherSearchIndex *
+applauncher_search_index_new (ApplauncherSearchKey * const *keys,
+                              guint                         n_keys)
+{
+	guint i;
+	ApplauncherSearchIndex *index;
+
+	index = g_slice_new0 (ApplauncherSearchIndex);
+	index->ref_count = 1;
+	index->n_keys = n_keys;
+	index->keys = g_new0 (ApplauncherSearchKey *, MAX (n_keys, 1));
+	index->postings = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                             NULL, (GDestroyNotify)g_array_unref);
+
+	for (i = 0; i < n_keys; i++) {
+		const gchar *p;
+		gsize len, pos;
+
+		if (!keys[i])
+			continue;
+
+		index->keys[i] = applauncher_search_key_ref (keys[i]);
+
+		p = keys[i]->text;
+		len = keys[i]->field_start[APPLAUNCHER_SEARCH_N_FIELDS];
+
+		for (pos = 0; pos < len; pos++) {
+			/* 필드 구분자는 검색어에 나올 수 없으므로 색인하지 않는다. */
+			if (p[pos] == '\n')
+				continue;
+
+			index_add_gram (index->postings, GRAM (p + pos, 1), i);
+
+			if (pos + 1 < len && p[pos + 1] != '\n') {
+				index_add_gram (index->postings, GRAM (p + pos, 2), i);
+
+				if (pos + 2 < len && p[pos + 2] != '\n')
+					index_add_gram (index->postings, GRAM (p + pos, 3), i);
+			}
+		}
+	}
+
+	return index;
+}
+
+ApplauncherSearchIndex *
+applauncher_search_index_ref (ApplauncherSearchIndex *index)
+{
+	g_return_val_if_fail (index != NULL, NULL);
+
+	g_atomic_int_inc (&index->ref_count);
+
+	return index;
+}
+
+void
+applauncher_search_index_unref (ApplauncherSearchIndex *index)
+{
+	guint i;
+
+	if (!index || !g_atomic_int_dec_and_test (&index->ref_count))
+		return;
+
+	for (i = 0; i < index->n_keys; i++)
+		applauncher_search_key_unref (index->keys[i]);
+
+	g_hash_table_destroy (index->postings);
+	g_free (index->keys);
+	g_slice_free (ApplauncherSearchIndex, index);
+}
+
+const ApplauncherSearchKey *
+applauncher_search_index_get_key (const ApplauncherSearchIndex *index,
+                                  guint                         key_index)
+{
+	g_return_val_if_fail (index != NULL, NULL);
+
+	return (key_index < index->n_keys) ? index->keys[key_index] : NULL;
+}
+
+static gboolean
+posting_contains (GArray *list,
+                  guint   value)
+{
+	guint lo = 0, hi = list->len;
+
+	while (lo < hi) {
+		guint mid = lo + (hi - lo) / 2;
+		guint v = g_array_index (list, guint, mid);
+
+		if (v == value)
+			return TRUE;
+		if (v < value)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return FALSE;
+}
+
+static gint
+compare_posting_length (gconstpointer a, gconstpointer b)
+{
+	guint la = (*(GArray **)a)->len;
+	guint lb = (*(GArray **)b)->len;
+
+	return (la < lb) ? -1 : (la > lb);
+}
+
+/* 정규화된 query 를 포함하는 항목을 result 에 표시한다. */
+void
+applauncher_search_index_query (const ApplauncherSearchIndex *index,
+                                const gchar                  *query,
+                                ApplauncherBitset            *result)
+{
+	guint i, j;
+	gsize len, pos;
+	GArray *smallest;
+	GPtrArray *lists;
+
+	g_return_if_fail (index != NULL);
+	g_return_if_fail (result != NULL);
+
+	applauncher_bitset_resize (result, index->n_keys);
+
+	len = query ? strlen (query) : 0;
+	if (len == 0 || index->n_keys == 0)
+		return;
+
+	if (len < 3) {
+		GArray *list = g_hash_table_lookup (index->postings, GUINT_TO_POINTER (GRAM (query, len)));
+
+		for (i = 0; list && i < list->len; i++)
+			applauncher_bitset_add (result, g_array_index (list, guint, i));
+		return;
+	}
+
+	lists = g_ptr_array_sized_new (len - 2);
+	for (pos = 0; pos + 3 <= len; pos++) {
+		GArray *list = g_hash_table_lookup (index->postings, GUINT_TO_POINTER (GRAM (query + pos, 3)));
+
+		if (!list) {
+			g_ptr_array_unref (lists);
+			return;
+		}
+		g_ptr_array_add (lists, list);
+	}
+
+	/* 가장 짧은 목록을 기준으로 나머지 목록에 모두 있는 항목만 확인한다. */
+	g_ptr_array_sort (lists, compare_posting_length);
+	smallest = g_ptr_array_index (lists, 0);
+
+	for (i = 0; i < smallest->len; i++) {
+		guint key_index = g_array_index (smallest, guint, i);
+		gboolean candidate = TRUE;
+
+		for (j = 1; j < lists->len && candidate; j++) {
+			GArray *list = g_ptr_array_index (lists, j);
+			if (list != smallest)
+				candidate = posting_contains (list, key_index);
+		}
+
+		if (candidate && applauncher_search_key_match (index->keys[key_index], query))
+			applauncher_bitset_add (result, key_index);
+	}
+
+	g_ptr_array_unref (lists);
+}
+
+/* previous 는 query 의 부분 문자열로 얻은 결과이므로 그 안에서만 다시 확인한다. */
+void
+applauncher_search_index_refine (const ApplauncherSearchIndex *index,
+                                 const gchar                  *query,
+                                 const ApplauncherBitset      *previous,
+                                 ApplauncherBitset            *result)
+{
+	gint i;
+
+	g_return_if_fail (index != NULL);
+	g_return_if_fail (previous != NULL);
+	g_return_if_fail (result != NULL);
+
+	applauncher_bitset_resize (result, index->n_keys);
+
+	if (!query || *query == '\0')
+		return;
+
+	for (i = applauncher_bitset_next (previous, -1); i >= 0; i = applauncher_bitset_next (previous, i)) {
+		if ((guint)i < index->n_keys && applauncher_search_key_match (index->keys[i], query))
+			applauncher_bitset_add (result, i);
+	}
+}
+
+static void
+session_state_free (SessionState *state)
+{
+	g_free (state->query);
+	applauncher_bitset_free (state->matches);
+	g_slice_free (SessionState, state);
+}
+
+ApplauncherSearchSession *
+applauncher_search_session_new (void)
+{
+	ApplauncherSearchSession *session;
+
+	session = g_slice_new0 (ApplauncherSearchSession);
+	session->stack = g_ptr_array_new_with_free_func ((GDestroyNotify)session_state_free);
+
+	return session;
+}
+
+void
+applauncher_search_session_free (ApplauncherSearchSession *session)
+{
+	if (!session)
+		return;
+
+	g_ptr_array_unref (session->stack);
+	g_slice_free (ApplauncherSearchSession, session);
+}
+
+/* 색인이 바뀌면 이전 결과는 쓸 수 없으므로 반드시 호출해야 한다. */
+void
+applauncher_search_session_reset (ApplauncherSearchSession *session)
+{
+	g_return_if_fail (session != NULL);
+
+	g_ptr_array_set_size (session->stack, 0);
+	session->index = NULL;
+}
+
+/* 정규화된 query 의 결과를 돌려준다. 결과는 다음 호출 전까지 유효하다. */
+const ApplauncherBitset *
+applauncher_search_session_run (ApplauncherSearchSession     *session,
+                                const ApplauncherSearchIndex *index,
+                                const gchar                  *query)
+{
+	SessionState *top = NULL, *state;
+
+	g_return_val_if_fail (session != NULL, NULL);
+	g_return_val_if_fail (index != NULL, NULL);
+
+	if (session->index != index) {
+		applauncher_search_session_reset (session);
+		session->index = index;
+	}
+
+	if (!query)
+		query = "";
+
+	/* query 에 포함되지 않는 이전 검색어는 더 이상 쓸모가 없다. */
+	while (session->stack->len > 0) {
+		top = g_ptr_array_index (session->stack, session->stack->len - 1);
+		if (*query != '\0' && strstr (query, top->query) != NULL)
+			break;
+		g_ptr_array_remove_index (session->stack, session->stack->len - 1);
+		top = NULL;
+	}
+
+	if (top && g_str_equal (top->query, query))
+		return top->matches;
+
+	state = g_slice_new0 (SessionState);
+	state->query = g_strdup (query);
+	state->matches = applauncher_bitset_new (0);
+
+	if (top)
+		applauncher_search_index_refine (index, query, top->matches, state->matches);
+	else
+		applauncher_search_index_query (index, query, state->matches);
+
+	if (session->stack->len >= MAX_SESSION_DEPTH)
+		g_ptr_array_remove_index (session->stack, 0);
+	g_ptr_array_add (session->stack, state);
+
+	return state->matches;
+}
@@ -0,0 +1,101 @@
+/*
+ *  Copyright (C) 2018-2021 Gooroom <gooroom@gooroom.kr>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#ifndef __APPLAUNCHER_SEARCH_H__
+#define __APPLAUNCHER_SEARCH_H__
+
+#include <glib.h>
+
+#include "applauncher-bitset.h"
+
+G_BEGIN_DECLS
+
+typedef enum
+{
+	APPLAUNCHER_SEARCH_FIELD_NAME,
+	APPLAUNCHER_SEARCH_FIELD_UNTRANSLATED_NAME,
+	APPLAUNCHER_SEARCH_FIELD_GENERIC_NAME,
+	APPLAUNCHER_SEARCH_FIELD_KEYWORDS,
+	APPLAUNCHER_SEARCH_FIELD_EXEC,
+	APPLAUNCHER_SEARCH_FIELD_CHOSEONG,   /* 이름의 한글 초성 */
+	APPLAUNCHER_SEARCH_FIELD_COMMENT,
+	APPLAUNCHER_SEARCH_FIELD_CATEGORIES,
+	APPLAUNCHER_SEARCH_N_FIELDS
+} ApplauncherSearchField;
+
+typedef struct _ApplauncherSearchKey   ApplauncherSearchKey;
+typedef struct _ApplauncherSearchIndex ApplauncherSearchIndex;
+typedef struct _ApplauncherSearchSession ApplauncherSearchSession;
+
+/* 카탈로그를 읽을 때 한 번 만들어 두는 항목별 검색 키.
+ * 검색 스레드가 쓰는 동안 카탈로그가 바뀌어도 유지되도록 참조 계수를 가진다. */
+struct _ApplauncherSearchKey
+{
+	gint   ref_count;
+	gchar *text;                                      /* 정규화된 필드들을 '\n' 으로 이어 붙인 문자열 */
+	guint  field_start[APPLAUNCHER_SEARCH_N_FIELDS + 1]; /* 필드별 시작 위치, 마지막은 전체 길이 */
+};
+
+gchar                *applauncher_search_normalize (const gchar                *str);
+
+ApplauncherSearchKey *applauncher_search_key_new   (const gchar                *fields[APPLAUNCHER_SEARCH_N_FIELDS]);
+
+ApplauncherSearchKey *applauncher_search_key_ref   (ApplauncherSearchKey       *key);
+
+void                  applauncher_search_key_unref (ApplauncherSearchKey       *key);
+
+gboolean              applauncher_search_key_match (const ApplauncherSearchKey *key,
+                                                    const gchar                *query);
+
+gint                  applauncher_search_key_score (const ApplauncherSearchKey *key,
+                                                    const gchar                *query,
+                                                    gboolean                    fuzzy);
+
+ApplauncherSearchIndex *applauncher_search_index_new   (ApplauncherSearchKey * const       *keys,
+                                                        guint                               n_keys);
+
+ApplauncherSearchIndex *applauncher_search_index_ref   (ApplauncherSearchIndex             *index);
+
+void                    applauncher_search_index_unref (ApplauncherSearchIndex             *index);
+
+const ApplauncherSearchKey *applauncher_search_index_get_key (const ApplauncherSearchIndex *index,
+                                                              guint                         key_index);
+
+void                    applauncher_search_index_query (const ApplauncherSearchIndex       *index,
+                                                        const gchar                        *query,
+                                                        ApplauncherBitset                  *result);
+
+void                    applauncher_search_index_refine (const ApplauncherSearchIndex      *index,
+                                                         const gchar                       *query,
+                                                         const ApplauncherBitset           *previous,
+                                                         ApplauncherBitset                 *result);
+
+ApplauncherSearchSession *applauncher_search_session_new   (void);
+
+void                      applauncher_search_session_free  (ApplauncherSearchSession     *session);
+
+void                      applauncher_search_session_reset (ApplauncherSearchSession     *session);
+
+const ApplauncherBitset  *applauncher_search_session_run   (ApplauncherSearchSession     *session,
+                                                            const ApplauncherSearchIndex *index,
+                                                            const gchar                  *query);
+
+G_END_DECLS
+
+#endif /* !__APPLAUNCHER_SEARCH_H__ */
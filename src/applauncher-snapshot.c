@@ -0,0 +1,493 @@
+/*
+ *  Copyright (C) 2018-2021 Gooroom <gooroom@gooroom.kr>
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include "applauncher-catalog.h"
+#include "applauncher-snapshot.h"
+
+/*
+ * 카탈로그 스냅샷 파일 구조 (호스트 바이트 순서)
+ *
+ *   SnapshotHeader
+ *   SnapshotEntry     x n_entries
+ *   SnapshotDirectory x n_dirs
+ *   guint32           x n_members   (디렉토리별 항목 인덱스)
+ *   문자열 테이블     strings_size 바이트, NUL 로 끝나는 문자열들
+ *
+ * 문자열은 테이블 안의 오프셋으로 저장하며, 오프셋 0 은 NULL 을 뜻한다.
+ */
+
+#define SNAPSHOT_MAGIC   0x434c4147 /* "GALC" */
+#define SNAPSHOT_VERSION 4
+#define STAMP_MAX_DEPTH  8  /* 심볼릭 링크가 순환하는 경우를 막는다 */
+
+typedef struct
+{
+	guint32 magic;
+	guint32 version;
+	guint64 stamp;
+	guint32 n_entries;
+	guint32 n_dirs;
+	guint32 n_members;
+	guint32 strings_size;
+} SnapshotHeader;
+
+typedef struct
+{
+	guint32 desktop_id;
+	guint32 path;
+	guint32 name;
+	guint32 untranslated_name;
+	guint32 description;
+	guint32 generic_name;
+	guint32 keywords;
+	guint32 categories;
+	guint32 exec;
+	guint32 try_exec;
+	guint32 icon;
+} SnapshotEntry;
+
+typedef struct
+{
+	guint32 name;
+	guint32 icon;
+	guint32 path;
+	guint32 first_member;
+	guint32 n_members;
+} SnapshotDirectory;
+
+
+static guint64
+stamp_mix (guint64 stamp, gconstpointer data, gsize len)
+{
+	gsize i;
+	const guchar *p = data;
+
+	/* FNV-1a */
+	for (i = 0; i < len; i++) {
+		stamp ^= p[i];
+		stamp *= G_GUINT64_CONSTANT (1099511628211);
+	}
+
+	return stamp;
+}
+
+static guint64
+stamp_add_path (guint64 stamp, const gchar *path)
+{
+	GStatBuf buf;
+	gint64 values[3] = { -1, -1, -1 };
+
+	if (g_stat (path, &buf) == 0) {
+		values[0] = (gint64)buf.st_mtime;
+		values[1] = (gint64)buf.st_ino;
+		values[2] = (gint64)buf.st_size;
+	}
+
+	stamp = stamp_mix (stamp, path, strlen (path));
+
+	return stamp_mix (stamp, values, sizeof (values));
+}
+
+static gint
+compare_names (gconstpointer a, gconstpointer b)
+{
+	return strcmp (*(const gchar * const *)a, *(const gchar * const *)b);
+}
+
+/* 하위 디렉토리에 파일이 생기거나 지워져도 위쪽 디렉토리의 mtime 은 바뀌지 않으므로
+ * 하위 디렉토리까지 따라간다. 데스크톱 파일은 디렉토리가 아니므로 stat 하지 않는다. */
+static guint64
+stamp_add_tree (guint64 stamp, const gchar *path, gint depth)
+{
+	guint i;
+	GDir *dir;
+	GPtrArray *names;
+	const gchar *name;
+
+	stamp = stamp_add_path (stamp, path);
+
+	if (depth <= 0)
+		return stamp;
+
+	dir = g_dir_open (path, 0, NULL);
+	if (!dir)
+		return stamp;
+
+	names = g_ptr_array_new_with_free_func (g_free);
+	while ((name = g_dir_read_name (dir))) {
+		if (g_str_has_suffix (name, ".desktop") || g_str_has_suffix (name, ".directory"))
+			continue;
+		g_ptr_array_add (names, g_strdup (name));
+	}
+	g_dir_close (dir);
+
+	/* 읽는 순서는 파일 시스템에 따라 다르므로 정렬해서 섞는다. */
+	g_ptr_array_sort (names, compare_names);
+
+	for (i = 0; i < names->len; i++) {
+		gchar *child = g_build_filename (path, g_ptr_array_index (names, i), NULL);
+
+		if (g_file_test (child, G_FILE_TEST_IS_DIR))
+			stamp = stamp_add_tree (stamp, child, depth - 1);
+		g_free (child);
+	}
+
+	g_ptr_array_unref (names);
+
+	return stamp;
+}
+
+static guint64
+stamp_add_data_dirs (guint64 stamp, const gchar *subdir)
+{
+	gint i;
+	gchar *path;
+	const gchar * const *dirs = g_get_system_data_dirs ();
+
+	path = g_build_filename (g_get_user_data_dir (), subdir, NULL);
+	stamp = stamp_add_tree (stamp, path, STAMP_MAX_DEPTH);
+	g_free (path);
+
+	for (i = 0; dirs[i]; i++) {
+		path = g_build_filename (dirs[i], subdir, NULL);
+		stamp = stamp_add_tree (stamp, path, STAMP_MAX_DEPTH);
+		g_free (path);
+	}
+
+	return stamp;
+}
+
+gchar *
+applauncher_snapshot_get_path (void)
+{
+	gchar *name, *path;
+	const gchar * const *langs = g_get_language_names ();
+
+	/* 이름이 로케일에 따라 다르므로 로케일별로 저장한다. */
+	name = g_strdup_printf ("catalog-%s.cache", langs[0]);
+	path = g_build_filename (g_get_user_cache_dir (), PACKAGE_NAME, name, NULL);
+	g_free (name);
+
+	return path;
+}
+
+/* 응용 프로그램 디렉토리와 .menu 파일의 mtime 으로 스냅샷의 유효성을 판단한다.
+ * 응용 프로그램 디렉토리는 하위 디렉토리까지 확인한다. */
+guint64
+applauncher_snapshot_compute_stamp (const gchar *menu_basename)
+{
+	gint i;
+	gchar *path;
+	guint64 stamp = G_GUINT64_CONSTANT (14695981039346656037);
+	const gchar * const *dirs = g_get_system_config_dirs ();
+
+	stamp = stamp_mix (stamp, menu_basename, strlen (menu_basename));
+
+	stamp = stamp_add_data_dirs (stamp, "applications");
+	stamp = stamp_add_data_dirs (stamp, "desktop-directories");
+
+	path = g_build_filename (g_get_user_config_dir (), "menus", menu_basename, NULL);
+	stamp = stamp_add_path (stamp, path);
+	g_free (path);
+
+	for (i = 0; dirs[i]; i++) {
+		path = g_build_filename (dirs[i], "menus", menu_basename, NULL);
+		stamp = stamp_add_path (stamp, path);
+		g_free (path);
+	}
+
+	/* 패키지가 설치하는 메뉴 조각 */
+	path = g_build_filename (g_get_user_config_dir (), "menus", "applications-merged", NULL);
+	stamp = stamp_add_tree (stamp, path, 0);
+	g_free (path);
+
+	for (i = 0; dirs[i]; i++) {
+		path = g_build_filename (dirs[i], "menus", "applications-merged", NULL);
+		stamp = stamp_add_tree (stamp, path, 0);
+		g_free (path);
+	}
+
+	return stamp;
+}
+
+static gchar *
+snapshot_string (const gchar *strings, guint32 strings_size, guint32 offset, gboolean *valid)
+{
+	if (offset == 0)
+		return NULL;
+
+	if (offset >= strings_size) {
+		*valid = FALSE;
+		return NULL;
+	}
+
+	return g_strdup (strings + offset);
+}
+
+/* 스냅샷 파일을 메모리에 매핑해서 항목과 디렉토리를 만든다.
+ * stamp 가 다르거나 파일이 손상되었으면 FALSE 를 반환한다. */
+gboolean
+applauncher_snapshot_load (const gchar  *path,
+                           guint64       stamp,
+                           GPtrArray   **entries,
+                           GPtrArray   **dirs)
+{
+	guint i;
+	gsize size, expected;
+	gboolean valid = TRUE;
+	GMappedFile *map;
+	const gchar *contents, *strings;
+	const SnapshotHeader *header;
+	const SnapshotEntry *s_entries;
+	const SnapshotDirectory *s_dirs;
+	const guint32 *s_members;
+	GPtrArray *e_array, *d_array;
+
+	g_return_val_if_fail (path != NULL, FALSE);
+
+	map = g_mapped_file_new (path, FALSE, NULL);
+	if (!map)
+		return FALSE;
+
+	contents = g_mapped_file_get_contents (map);
+	size = g_mapped_file_get_length (map);
+
+	if (!contents || size < sizeof (SnapshotHeader))
+		goto fail;
+
+	header = (const SnapshotHeader *)contents;
+
+	if (header->magic != SNAPSHOT_MAGIC ||
+        header->version != SNAPSHOT_VERSION ||
+        header->stamp != stamp)
+		goto fail;
+
+	/* 32비트 카운트의 곱이므로 64비트에서 넘치지 않는다. */
+	expected = sizeof (SnapshotHeader) +
+               (guint64)header->n_entries * sizeof (SnapshotEntry) +
+               (guint64)header->n_dirs * sizeof (SnapshotDirectory) +
+               (guint64)header->n_members * sizeof (guint32) +
+               header->strings_size;
+
+	if (expected != size || header->strings_size == 0)
+		goto fail;
+
+	s_entries = (const SnapshotEntry *)(contents + sizeof (SnapshotHeader));
+	s_dirs = (const SnapshotDirectory *)(s_entries + header->n_entries);
+	s_members = (const guint32 *)(s_dirs + header->n_dirs);
+	strings = (const gchar *)(s_members + header->n_members);
+
+	if (strings[header->strings_size - 1] != '\0')
+		goto fail;
+
+	e_array = g_ptr_array_new_full (header->n_entries, (GDestroyNotify)applauncher_catalog_entry_free);
+	d_array = g_ptr_array_new_full (header->n_dirs, (GDestroyNotify)applauncher_catalog_directory_free);
+
+	for (i = 0; i < header->n_entries && valid; i++) {
+		const SnapshotEntry *se = &s_entries[i];
+		ApplauncherCatalogEntry *entry = applauncher_catalog_entry_new ();
+
+		entry->desktop_id = snapshot_string (strings, header->strings_size, se->desktop_id, &valid);
+		entry->path = snapshot_string (strings, header->strings_size, se->path, &valid);
+		entry->name = snapshot_string (strings, header->strings_size, se->name, &valid);
+		entry->untranslated_name = snapshot_string (strings, header->strings_size, se->untranslated_name, &valid);
+		entry->description = snapshot_string (strings, header->strings_size, se->description, &valid);
+		entry->generic_name = snapshot_string (strings, header->strings_size, se->generic_name, &valid);
+		entry->keywords = snapshot_string (strings, header->strings_size, se->keywords, &valid);
+		entry->categories = snapshot_string (strings, header->strings_size, se->categories, &valid);
+		entry->exec = snapshot_string (strings, header->strings_size, se->exec, &valid);
+		entry->try_exec = snapshot_string (strings, header->strings_size, se->try_exec, &valid);
+		entry->icon = snapshot_string (strings, header->strings_size, se->icon, &valid);
+		entry->index = i;
+
+		if (!entry->desktop_id || !entry->path || !entry->name)
+			valid = FALSE;
+
+		g_ptr_array_add (e_array, entry);
+	}
+
+	for (i = 0; i < header->n_dirs && valid; i++) {
+		guint m;
+		const SnapshotDirectory *sd = &s_dirs[i];
+		ApplauncherCatalogDirectory *dir = applauncher_catalog_directory_new ();
+
+		dir->name = snapshot_string (strings, header->strings_size, sd->name, &valid);
+		dir->icon = snapshot_string (strings, header->strings_size, sd->icon, &valid);
+		dir->path = snapshot_string (strings, header->strings_size, sd->path, &valid);
+
+		if ((guint64)sd->first_member + sd->n_members > header->n_members)
+			valid = FALSE;
+
+		for (m = 0; valid && m < sd->n_members; m++) {
+			guint index = s_members[sd->first_member + m];
+			if (index >= header->n_entries) {
+				valid = FALSE;
+				break;
+			}
+			g_array_append_val (dir->members, index);
+		}
+
+		g_ptr_array_add (d_array, dir);
+	}
+
+	g_mapped_file_unref (map);
+
+	if (!valid) {
+		g_ptr_array_unref (e_array);
+		g_ptr_array_unref (d_array);
+		return FALSE;
+	}
+
+	*entries = e_array;
+	*dirs = d_array;
+
+	return TRUE;
+
+fail:
+	g_mapped_file_unref (map);
+
+	return FALSE;
+}
+
+static guint32
+string_table_add (GString *strings, GHashTable *offsets, const gchar *str)
+{
+	gpointer value;
+	guint32 offset;
+
+	if (!str)
+		return 0;
+
+	if (g_hash_table_lookup_extended (offsets, str, NULL, &value))
+		return GPOINTER_TO_UINT (value);
+
+	offset = strings->len;
+	g_string_append_len (strings, str, strlen (str) + 1);
+	g_hash_table_insert (offsets, (gpointer)str, GUINT_TO_POINTER (offset));
+
+	return offset;
+}
+
+gboolean
+applauncher_snapshot_save (const gchar  *path,
+                           guint64       stamp,
+                           GPtrArray    *entries,
+                           GPtrArray    *dirs,
+                           GError      **error)
+{
+	guint i;
+	gboolean ret;
+	gchar *dirname;
+	GString *strings;
+	GHashTable *offsets;
+	GByteArray *buf;
+	GArray *s_entries, *s_dirs, *s_members;
+	SnapshotHeader header;
+
+	g_return_val_if_fail (path != NULL, FALSE);
+	g_return_val_if_fail (entries != NULL && dirs != NULL, FALSE);
+
+	strings = g_string_new (NULL);
+	/* 오프셋 0 은 NULL 로 사용한다. */
+	g_string_append_c (strings, '\0');
+	offsets = g_hash_table_new (g_str_hash, g_str_equal);
+
+	s_entries = g_array_sized_new (FALSE, TRUE, sizeof (SnapshotEntry), entries->len);
+	s_dirs = g_array_sized_new (FALSE, TRUE, sizeof (SnapshotDirectory), dirs->len);
+	s_members = g_array_new (FALSE, FALSE, sizeof (guint32));
+
+	for (i = 0; i < entries->len; i++) {
+		SnapshotEntry se;
+		ApplauncherCatalogEntry *entry = g_ptr_array_index (entries, i);
+
+		se.desktop_id = string_table_add (strings, offsets, entry->desktop_id);
+		se.path = string_table_add (strings, offsets, entry->path);
+		se.name = string_table_add (strings, offsets, entry->name);
+		se.untranslated_name = string_table_add (strings, offsets, entry->untranslated_name);
+		se.description = string_table_add (strings, offsets, entry->description);
+		se.generic_name = string_table_add (strings, offsets, entry->generic_name);
+		se.keywords = string_table_add (strings, offsets, entry->keywords);
+		se.categories = string_table_add (strings, offsets, entry->categories);
+		se.exec = string_table_add (strings, offsets, entry->exec);
+		se.try_exec = string_table_add (strings, offsets, entry->try_exec);
+		se.icon = string_table_add (strings, offsets, entry->icon);
+
+		g_array_append_val (s_entries, se);
+	}
+
+	for (i = 0; i < dirs->len; i++) {
+		guint m;
+		SnapshotDirectory sd;
+		ApplauncherCatalogDirectory *dir = g_ptr_array_index (dirs, i);
+
+		sd.name = string_table_add (strings, offsets, dir->name);
+		sd.icon = string_table_add (strings, offsets, dir->icon);
+		sd.path = string_table_add (strings, offsets, dir->path);
+		sd.first_member = s_members->len;
+		sd.n_members = dir->members->len;
+
+		for (m = 0; m < dir->members->len; m++) {
+			guint32 index = g_array_index (dir->members, guint, m);
+			g_array_append_val (s_members, index);
+		}
+
+		g_array_append_val (s_dirs, sd);
+	}
+
+	memset (&header, 0, sizeof (header));
+	header.magic = SNAPSHOT_MAGIC;
+	header.version = SNAPSHOT_VERSION;
+	header.stamp = stamp;
+	header.n_entries = s_entries->len;
+	header.n_dirs = s_dirs->len;
+	header.n_members = s_members->len;
+	header.strings_size = strings->len;
+
+	buf = g_byte_array_new ();
+	g_byte_array_append (buf, (const guint8 *)&header, sizeof (header));
+	g_byte_array_append (buf, (const guint8 *)s_entries->data, s_entries->len * sizeof (SnapshotEntry));
+	g_byte_array_append (buf, (const guint8 *)s_dirs->data, s_dirs->len * sizeof (SnapshotDirectory));
+	g_byte_array_append (buf, (const guint8 *)s_members->data, s_members->len * sizeof (guint32));
+	g_byte_array_append (buf, (const guint8 *)strings->str, strings->len);
+
+	dirname = g_path_get_dirname (path);
+	g_mkdir_with_parents (dirname, 0700);
+	g_free (dirname);
+
+	/* 임시 파일에 쓴 뒤 이름을 바꾸므로 매핑된 이전 파일은 영향을 받지 않는다. */
+	ret = g_file_set_contents (path, (const gchar *)buf->data, buf->len, error);
+
+	g_byte_array_unref (buf);
+	g_array_unref (s_entries);
+	g_array_unref (s_dirs);
+	g_array_unref (s_members);
+	g_hash_table_destroy (offsets);
+	g_string_free (strings, TRUE);
+
+	return ret;
+}
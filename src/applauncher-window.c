@@ -39,7 +39,10 @@
 
 #include <gmenu-tree.h>
 
-#include "panel-glib.h"
+#include "applauncher-catalog.h"
+#include "applauncher-hangul.h"
+#include "applauncher-search-cache.h"
+#include "applauncher-history.h"
 #include "applauncher-window.h"
 #include "applauncher-indicator.h"
 #include "applauncher-appitem.h"
@@ -66,11 +69,6 @@ static gboolean on_directory_item_leave_notify_event_cb (GtkWidget     *widget,
                                                          GdkEventFocus *event,
                                                          gpointer       data);
 
-static GSList *get_all_applications_from_dir (GMenuTreeDirectory  *directory,
-                                              GSList              *list);
-
-static gint applications_compare_by_id (GMenuTreeEntry *a, GMenuTreeEntry *b);
-
 struct _ApplauncherWindowPrivate
 {
 	GtkWidget *grid;
@@ -86,17 +84,58 @@ struct _ApplauncherWindowPrivate
 
 	ApplauncherIndicator *pages;
 
-	GSList *dirs;
-	GSList *apps;
-	GSList *cur_apps;
-	GSList *filtered_apps;
-
-	GList *grid_children;
+	ApplauncherCatalog *catalog;
+	ApplauncherSearchCache *search_cache; /* 애플릿 소유 */
+	ApplauncherHistory *history;          /* 애플릿 소유 */
+	ApplauncherIconCache *icon_cache;     /* 애플릿 소유 */
+	guint history_serial;                 /* 자주 쓰는 항목을 구했을 때의 기록 */
+
+	GPtrArray *dirs;          /* 카탈로그 소유 */
+	GPtrArray *apps;          /* 카탈로그 소유 */
+	GPtrArray *cur_apps;
+	GArray *cur_indices;        /* cur_apps 의 카탈로그 인덱스, 검색 스레드와 공유하므로 새로 만들어 바꾼다 */
+	GPtrArray *filtered_apps;
+	guint ranked_apps;          /* filtered_apps 앞쪽에서 순위대로 정렬된 개수 */
+	GHashTable *seen_names;     /* 이름 중복 제거용 집합 */
+	ApplauncherBitset *cur_set; /* 현재 디렉토리에서 보이는 항목 */
+	guint cur_dir_pos;          /* 현재 디렉토리의 dirs 안에서의 위치 */
+	ApplauncherSearchSession *search; /* 입력 중인 검색어의 결과 */
+	ApplauncherSearchSession *hangul_search; /* 조합 중인 한글을 풀어 쓴 검색어의 결과 */
+	gchar *hangul_key;
+	GTask *search_task;         /* 진행 중인 검색, 참조를 갖지 않음 */
+	GCancellable *search_cancellable;
+	guint search_delivered;     /* 진행 중인 검색에서 filtered_apps 에 담은 결과 수 */
+	gboolean activate_pending;  /* 검색 결과가 오면 첫 항목을 실행한다 */
+
+	GPtrArray *grid_children;
 
 	int grid_x;
 	int grid_y;
 	int icon_size;
 
+	/* 항목 크기 캐시: 글꼴, 배율, 아이콘 크기, 카탈로그 세대가 같으면 재사용한다. */
+	gchar *item_font;
+	int item_scale;
+	int item_icon_size;
+	guint item_generation;
+	int item_size;
+
+	int probe_width;
+	int probe_one_line_height;
+	int probe_two_lines_height;
+	PangoLayout *name_layout;
+
+	/* 그리드 배치 캐시: 항목 크기별 창 여백과 작업 영역별 행/열 수 */
+	int layout_item_size;
+	int min_popup_width;
+	int min_popup_height;
+	int chrome_width;
+	int chrome_height;
+	int layout_workarea_width;
+	int layout_workarea_height;
+	int layout_rows;
+	int layout_cols;
+
 	int x;
 	int y;
 	int width;
@@ -111,6 +150,7 @@ struct _ApplauncherWindowPrivate
 	GdkRectangle workarea;
 
 	gchar *filter_text;
+	gchar *filter_key;          /* 정규화된 filter_text */
 
 	guint idle_entry_changed_id;
 	guint idle_directory_changed_id;
@@ -124,6 +164,7 @@ struct _ApplauncherWindowPrivate
 enum {
 	CLOSED,
 	LAUNCH_DESKTOP,
+	RELOADED,
 	LAST_SIGNAL
 };
 
@@ -133,508 +174,607 @@ static guint signals[LAST_SIGNAL] = { 0 };
 G_DEFINE_TYPE_WITH_PRIVATE (ApplauncherWindow, applauncher_window, GTK_TYPE_WINDOW)
 
 
-static gboolean
-find_entry (GSList *list, GMenuTreeEntry *entry)
+static guint
+entry_name_hash (gconstpointer key)
 {
-	const gchar *application_name;
-	if (entry) {
-		GDesktopAppInfo *dt_info = gmenu_tree_entry_get_app_info (entry);
-		if (dt_info) {
-			application_name = g_app_info_get_name (G_APP_INFO (dt_info));
-		} else {
-			application_name = NULL;
-		}
-	} else {
-		application_name = NULL;
-	}
+	return ((const ApplauncherCatalogEntry *)key)->name_hash;
+}
 
-	if (!application_name) return FALSE;
+static gboolean
+entry_name_equal (gconstpointer a, gconstpointer b)
+{
+	return g_str_equal (((const ApplauncherCatalogEntry *)a)->name,
+                        ((const ApplauncherCatalogEntry *)b)->name);
+}
 
-	GSList *l = NULL;
-	for (l = list; l; l = l->next) {
-		GMenuTreeEntry *entry = (GMenuTreeEntry *)l->data;
-		if (entry) {
-			GDesktopAppInfo *dt_info = gmenu_tree_entry_get_app_info (entry);
-			if (dt_info) {
-				const gchar *name = g_app_info_get_name (G_APP_INFO (dt_info));
-				return (g_str_equal (name, application_name));
-			}
-		}
-	}
+/* 같은 이름의 항목이 이미 추가되었으면 FALSE 를 돌려준다. */
+static gboolean
+add_unique_entry (ApplauncherWindow *window, ApplauncherCatalogEntry *entry)
+{
+	if (!entry->name)
+		return TRUE;
 
-	return FALSE;
+	return g_hash_table_add (window->priv->seen_names, entry);
 }
 
-static gboolean
-match_desktop (const gchar *desktop_id, const gchar *match_str)
+#define DESKTOP_ID_SCORE G_MAXINT
+
+/* 점수가 높은 순서, 같으면 자주 실행한 순서, 그 다음은 카탈로그 순서 */
+static gint
+compare_ranked_entries (gconstpointer a, gconstpointer b)
 {
-	gboolean ret = FALSE;
-	GDesktopAppInfo *dt_info = NULL;
+	const ApplauncherCatalogEntry *ea = *(ApplauncherCatalogEntry * const *)a;
+	const ApplauncherCatalogEntry *eb = *(ApplauncherCatalogEntry * const *)b;
 
-	if (!desktop_id || !match_str || g_str_equal (match_str, ""))
-		return FALSE;
+	if (ea->search_score != eb->search_score)
+		return (ea->search_score > eb->search_score) ? -1 : 1;
 
-	if (g_str_equal (desktop_id, match_str))
-		return TRUE;
+	if (ea->launch_score != eb->launch_score)
+		return (ea->launch_score > eb->launch_score) ? -1 : 1;
 
-	dt_info = g_desktop_app_info_new (desktop_id);
-	if (!dt_info)
-		return FALSE;
+	return (ea->index < eb->index) ? -1 : (ea->index > eb->index);
+}
 
-	while (1) {
-		gchar *name = NULL, *locale_name = NULL, *exec = NULL;
+/* items 의 앞쪽 k 개에 순위가 가장 높은 항목들이 (정렬되지 않은 채로) 오도록 나눈다. */
+static void
+select_top_entries (gpointer *items, guint n, guint k)
+{
+	guint lo = 0, hi = n;
 
-		name = g_desktop_app_info_get_string (dt_info, G_KEY_FILE_DESKTOP_KEY_NAME);
-		if (name && ((g_utf8_collate (name, match_str) == 0) || (panel_g_utf8_strstrcase (name, match_str) != NULL))) {
-			g_free (name);
-			ret = TRUE;
-			break;
-		}
+	while (lo + 1 < hi) {
+		guint i, store = lo;
+		gpointer pivot, tmp;
 
-		locale_name = g_desktop_app_info_get_locale_string (dt_info, G_KEY_FILE_DESKTOP_KEY_NAME);
-		if (locale_name && ((g_utf8_collate (locale_name, match_str) == 0) || (panel_g_utf8_strstrcase (locale_name, match_str) != NULL))) {
-			g_free (locale_name);
-			ret = TRUE;
-			break;
-		}
+		tmp = items[lo + (hi - lo) / 2];
+		items[lo + (hi - lo) / 2] = items[hi - 1];
+		items[hi - 1] = pivot = tmp;
 
-		exec = g_desktop_app_info_get_string (dt_info, G_KEY_FILE_DESKTOP_KEY_EXEC);
-		if (exec && ((g_utf8_collate (exec, match_str) == 0) || (panel_g_utf8_strstrcase (exec, match_str) != NULL))) {
-			g_free (exec);
-			ret = TRUE;
-			break;
+		for (i = lo; i < hi - 1; i++) {
+			if (compare_ranked_entries (&items[i], &pivot) < 0) {
+				tmp = items[i];
+				items[i] = items[store];
+				items[store++] = tmp;
+			}
 		}
 
-		break;
+		items[hi - 1] = items[store];
+		items[store] = pivot;
+
+		if (store == k)
+			return;
+		if (k < store)
+			hi = store;
+		else
+			lo = store + 1;
 	}
+}
+
+/* 앞쪽 count 개의 항목이 순위대로 정렬되도록 한다. 나머지는 필요할 때 정렬한다. */
+static void
+ensure_ranked_apps (ApplauncherWindow *window, guint count)
+{
+	guint n, k;
+	gpointer *items;
+	ApplauncherWindowPrivate *priv = window->priv;
+
+	count = MIN (count, priv->filtered_apps->len);
+	if (count <= priv->ranked_apps)
+		return;
+
+	items = priv->filtered_apps->pdata + priv->ranked_apps;
+	n = priv->filtered_apps->len - priv->ranked_apps;
+	k = count - priv->ranked_apps;
 
-	g_object_unref (dt_info);
+	if (k < n)
+		select_top_entries (items, n, k);
+	g_qsort_with_data (items, k, sizeof (gpointer), (GCompareDataFunc)compare_ranked_entries, NULL);
 
-	return ret;
+	priv->ranked_apps = count;
 }
 
-gchar *
-get_applications_menu (void)
+static int
+get_total_pages (ApplauncherWindow *window, guint size)
 {
-	return g_strdup ("gnome-applications.menu");
-}
+	ApplauncherWindowPrivate *priv = window->priv;
 
+	gint  num_pages = 0;
 
-/* Copied from gnome-panel-3.26.0/gnome-panel/panel-run-dialog.c:
- * get_all_applications_from_alias () */
-static GSList *
-get_all_applications_from_alias (GMenuTreeAlias *alias,
-                                 GSList         *list)
-{
-	switch (gmenu_tree_alias_get_aliased_item_type (alias))
-	{
-		case GMENU_TREE_ITEM_ENTRY: {
-			GMenuTreeEntry *entry = gmenu_tree_alias_get_aliased_entry (alias);
-			list = g_slist_append (list, entry);
-			break;
-		}
+	if (size > 0 && priv->grid_x > 0 && priv->grid_y > 0) {
+		num_pages = (int)(size / (priv->grid_y * priv->grid_x));
 
-		case GMENU_TREE_ITEM_DIRECTORY: {
-			GMenuTreeDirectory *directory = gmenu_tree_alias_get_aliased_directory (alias);
-			list = get_all_applications_from_dir (directory, list);
-			gmenu_tree_item_unref (directory);
-			break;
+		if ((size %  (priv->grid_y * priv->grid_x)) > 0) {
+			num_pages += 1;
 		}
-
-		default:
-			break;
 	}
 
-	return list;
+	return num_pages;
 }
 
-/* Copied from gnome-panel-3.26.0/gnome-panel/panel-run-dialog.c:
- * get_all_applications_from_dir () */
-static GSList *
-get_all_applications_from_dir (GMenuTreeDirectory  *directory,
-                               GSList              *list)
+static void
+update_pages (ApplauncherWindow *window)
 {
-	GMenuTreeIter *iter;
-	GMenuTreeItemType next_type;
-
-	iter = gmenu_tree_directory_iter (directory);
+	ApplauncherWindowPrivate *priv = window->priv;
 
-	while ((next_type = gmenu_tree_iter_next (iter)) != GMENU_TREE_ITEM_INVALID) {
-		switch (next_type) {
-			case GMENU_TREE_ITEM_ENTRY: {
-				list = g_slist_append (list, gmenu_tree_iter_get_entry (iter));
-				break;
-			}
+	/* 검색 결과가 없으면 페이지가 0 개이므로 표시기를 숨긴다. */
+	gint filtered_pages = get_total_pages (window, priv->filtered_apps->len);
 
-			case GMENU_TREE_ITEM_DIRECTORY: {
-				GMenuTreeDirectory *dir = gmenu_tree_iter_get_directory (iter);
-				if (g_str_has_suffix (gmenu_tree_directory_get_desktop_file_path (dir),
-                                      "chrome-apps.directory")) {
-					gmenu_tree_item_unref (dir);
-					break;
-	            }
-				list = get_all_applications_from_dir (dir, list);
-				gmenu_tree_item_unref (dir);
-				break;
-			}
+	// Update pages
+	if (filtered_pages > 1) {
+		gtk_stack_set_visible_child_name (GTK_STACK (priv->stk_bottom), "indicator");
+		GList *children = applauncher_indicator_get_children (priv->pages);
 
-			case GMENU_TREE_ITEM_ALIAS: {
-				GMenuTreeAlias *alias = gmenu_tree_iter_get_alias (iter);
-				list = get_all_applications_from_alias (alias, list);
-				gmenu_tree_item_unref (alias);
-				break;
+		int p;
+		for (p = 1; children; p++, children = children->next) {
+			GtkWidget *child = children->data;
+			if (child) {
+				gboolean visible = (p > filtered_pages) ? FALSE : TRUE;
+				gtk_widget_set_visible (child, visible);
 			}
-
-			default:
-			break;
 		}
+	} else {
+		gtk_stack_set_visible_child_name (GTK_STACK (priv->stk_bottom), "fake");
 	}
-
-	gmenu_tree_iter_unref (iter);
-
-	return g_slist_sort (list, (GCompareFunc)applications_compare_by_id);
 }
 
-static GSList *
-get_all_directories (void)
+static void
+update_grid (ApplauncherWindow *window)
 {
-	GMenuTree          *tree;
-	GMenuTreeDirectory *root;
-	GSList             *list = NULL;
-	gchar *applications_menu = NULL;
-
-	applications_menu = get_applications_menu ();
-
-	tree = gmenu_tree_new (applications_menu, GMENU_TREE_FLAGS_SORT_DISPLAY_NAME);
-	g_free (applications_menu);
+	ApplauncherWindowPrivate *priv = window->priv;
 
-	if (!gmenu_tree_load_sync (tree, NULL)) {
-		g_object_unref (tree);
-		return NULL;
+	guint pos;
+	if (priv->filtered_apps->len == 0) {
+		for (pos = 0; pos < priv->grid_children->len; pos++) {
+			ApplauncherAppItem *item = g_ptr_array_index (priv->grid_children, pos);
+			gtk_widget_set_sensitive (GTK_WIDGET (item), FALSE);
+			applauncher_appitem_change_app (item, NULL, NULL, NULL, NULL);
+		}
+		return;
 	}
 
-	root = gmenu_tree_get_root_directory (tree);
-
-	list = g_slist_append (list, root);
+	/* 현재 페이지의 첫 항목부터 그리드 칸 수만큼만 바로 접근한다. */
+	gint active = applauncher_indicator_get_active (priv->pages);
+	guint item_iter = active * priv->grid_y * priv->grid_x;
 
-	GMenuTreeIter *iter;
-	GMenuTreeItemType next_type;
+	ensure_ranked_apps (window, item_iter + priv->grid_children->len);
 
-	iter = gmenu_tree_directory_iter (root);
+	for (pos = 0; pos < priv->grid_children->len; pos++) {
+		ApplauncherAppItem *item = g_ptr_array_index (priv->grid_children, pos);
+		gtk_widget_set_state_flags (GTK_WIDGET (item), GTK_STATE_FLAG_NORMAL, TRUE);
+		if (item_iter < priv->filtered_apps->len) {
+			ApplauncherCatalogEntry *entry = g_ptr_array_index (priv->filtered_apps, item_iter);
 
-	while ((next_type = gmenu_tree_iter_next (iter)) != GMENU_TREE_ITEM_INVALID) {
-		switch (next_type) {
-			case GMENU_TREE_ITEM_DIRECTORY:
-			{
-				if (g_str_has_suffix (gmenu_tree_directory_get_desktop_file_path (gmenu_tree_iter_get_directory(iter)), "chrome-apps.directory")) {
-					break;
-				}
-				list = g_slist_append (list, gmenu_tree_iter_get_directory (iter));
-				break;
+			if (!entry) {
+				item_iter++;
+				gtk_widget_set_sensitive (GTK_WIDGET (item), FALSE);
+				continue;
 			}
 
-			default:
-				break;
+			GIcon *icon = applauncher_catalog_entry_get_icon (entry);
+			const gchar *name = entry->name;
+			const gchar *desc = entry->description;
+			const gchar *desktop_id = entry->path;
+
+			gtk_widget_set_sensitive (GTK_WIDGET (item), TRUE);
+			if (desc == NULL || g_strcmp0 (desc, "") == 0) {
+				applauncher_appitem_change_app (item, icon, name, name, desktop_id);
+			} else {
+				gchar *tooltip = g_strdup_printf ("%s:\n%s", name, desc);
+				applauncher_appitem_change_app (item, icon, name, tooltip, desktop_id);
+				g_free (tooltip);
+			}
+		} else { // fill with a blank one
+			gtk_widget_set_sensitive (GTK_WIDGET (item), FALSE);
+			applauncher_appitem_change_app (item, NULL, NULL, NULL, NULL);
 		}
+
+		item_iter++;
 	}
 
-	g_object_unref (tree);
+	// Update number of pages
+	update_pages (window);
+}
 
-	return list;
+static void
+pages_activate_cb (ApplauncherIndicator *indicator, gpointer data)
+{
+	ApplauncherWindow *window = APPLAUNCHER_WINDOW (data);
+
+	update_grid (window);
 }
 
-/* Copied from gnome-panel-3.26.0/gnome-panel/panel-run-dialog.c:
- * get_all_applications () */
-static GSList *
-get_all_applications (void)
+/* 검색 스레드에 넘기는 스냅샷. 카탈로그가 바뀌어도 그대로 쓸 수 있도록
+ * 색인과 cur_indices 는 참조를 가지고, 일치 집합은 복사해 둔다. */
+typedef struct
+{
+	ApplauncherSearchIndex *index;
+	GArray                 *candidates;  /* cur_apps 항목들의 카탈로그 인덱스 */
+	ApplauncherBitset      *match_set;
+	ApplauncherBitset      *hangul_set;
+	gchar                  *key;
+	gchar                  *hangul_key;
+	gint                    id_pos;      /* desktop id 가 검색어와 같은 항목의 위치, 없으면 -1 */
+	guint                   page_size;
+	gboolean                fuzzy;
+
+	/* 결과를 캐시에 넣을 때 쓰는 키 */
+	gboolean                cacheable;
+	guint                   generation;
+	guint                   directory;
+} SearchJob;
+
+/* 퍼지 일치를 기다리지 않고 먼저 보여줄 첫 페이지 */
+typedef struct
 {
-	GMenuTree          *tree;
-	GMenuTreeDirectory *root;
-	GSList             *list = NULL;
-	gchar *applications_menu = NULL;
+	GTask  *task;
+	GArray *hits;
+} SearchPage;
 
-	applications_menu = get_applications_menu ();
+#define SEARCH_CANCEL_CHECK_INTERVAL 64
 
-	tree = gmenu_tree_new (applications_menu, GMENU_TREE_FLAGS_SORT_DISPLAY_NAME);
-	g_free (applications_menu);
+static void
+search_job_free (SearchJob *job)
+{
+	applauncher_search_index_unref (job->index);
+	g_array_unref (job->candidates);
+	if (job->match_set)
+		applauncher_bitset_free (job->match_set);
+	if (job->hangul_set)
+		applauncher_bitset_free (job->hangul_set);
+	g_free (job->key);
+	g_free (job->hangul_key);
+	g_slice_free (SearchJob, job);
+}
 
-	if (!gmenu_tree_load_sync (tree, NULL)) {
-		g_object_unref (tree);
-		return NULL;
-	}
+static void
+search_page_free (SearchPage *page)
+{
+	g_object_unref (page->task);
+	g_array_unref (page->hits);
+	g_slice_free (SearchPage, page);
+}
 
-	root = gmenu_tree_get_root_directory (tree);
+static ApplauncherBitset *
+copy_match_set (const ApplauncherBitset *set)
+{
+	ApplauncherBitset *copy;
 
-	list = get_all_applications_from_dir (root, NULL);
+	if (!set)
+		return NULL;
 
-	gmenu_tree_item_unref (root);
-	g_object_unref (tree);
+	copy = applauncher_bitset_new (0);
+	applauncher_bitset_copy (copy, set);
 
-	return list;
+	return copy;
 }
 
+/* 색인에서 검색어를 포함한다고 확인된 항목의 점수. 일치하지 않으면 -1 이다. */
 static gint
-applications_compare_by_id (GMenuTreeEntry *a, GMenuTreeEntry *b)
-{
-	GAppInfo *app_a = NULL;
-	GAppInfo *app_b = NULL;
-	const gchar *id_a = NULL;
-	const gchar *id_b = NULL;
-
-	app_a = G_APP_INFO (gmenu_tree_entry_get_app_info (a));
-	app_b = G_APP_INFO (gmenu_tree_entry_get_app_info (b));
-
-	if (app_a)
-		id_a = g_app_info_get_id ((GAppInfo *)app_a);
-	if (app_b)
-		id_b = g_app_info_get_id ((GAppInfo *)app_b);
-
-	if (id_a == NULL && id_b == NULL)
-		return 0;
-	if (id_a == NULL)
-		return -1;
-	if (id_b == NULL)
-		return 1;
+search_job_score (SearchJob *job,
+                  guint      pos)
+{
+	gint score = -1;
+	guint index = g_array_index (job->candidates, guint, pos);
+	const ApplauncherSearchKey *key = applauncher_search_index_get_key (job->index, index);
+
+	if ((gint)pos == job->id_pos)
+		return DESKTOP_ID_SCORE;
+
+	if (job->match_set && applauncher_bitset_contains (job->match_set, index))
+		score = applauncher_search_key_score (key, job->key, FALSE);
 
-	return strcmp (id_a, id_b);
+	if (job->hangul_set && applauncher_bitset_contains (job->hangul_set, index))
+		score = MAX (score, applauncher_search_key_score (key, job->hangul_key, FALSE));
+
+	return score;
 }
 
+static gboolean search_page_ready_cb (gpointer data);
+
+/* 부분 문자열 일치는 항상 퍼지 일치보다 순위가 높으므로, 먼저 매긴 일치만으로
+ * 첫 페이지가 채워지면 그 페이지는 더 바뀌지 않는다. 이 때는 페이지를 먼저 넘기고
+ * 나머지 항목의 퍼지 일치를 계속한다. */
 static void
-apply_blacklist (void)
+search_thread (GTask        *task,
+               gpointer      source_object,
+               gpointer      task_data,
+               GCancellable *cancellable)
 {
-	gboolean has_exec_perm = TRUE;
-	GList *all_apps = NULL, *l = NULL;
+	guint i;
+	GArray *hits, *pending;
+	SearchJob *job = task_data;
 
-	all_apps = g_app_info_get_all ();
+	hits = g_array_new (FALSE, FALSE, sizeof (ApplauncherSearchResult));
+	pending = g_array_new (FALSE, FALSE, sizeof (guint));
 
-	for (l = all_apps; l; l = l->next) {
-		GAppInfo *appinfo = G_APP_INFO (l->data);
-		if (!appinfo)
-			continue;
+	for (i = 0; i < job->candidates->len; i++) {
+		ApplauncherSearchResult hit;
 
-		const gchar *id = g_app_info_get_id (appinfo);
-		const gchar *name = g_app_info_get_name (appinfo);
-		const gchar *desc = g_app_info_get_description (appinfo);
+		if (i % SEARCH_CANCEL_CHECK_INTERVAL == 0 && g_task_return_error_if_cancelled (task))
+			goto out;
 
-		GDesktopAppInfo *dt_info = g_desktop_app_info_new (id);
-		char *exec =  g_desktop_app_info_get_string (dt_info, G_KEY_FILE_DESKTOP_KEY_EXEC);
-
-		if (exec) {
-			gchar **argv;
-			g_shell_parse_argv (exec, NULL, &argv, NULL);
-
-			if (g_strv_length (argv) > 0) {
-				gchar *cmd;
-				GStatBuf stat_buf;
+		hit.index = g_array_index (job->candidates, guint, i);
+		hit.score = search_job_score (job, i);
+		if (hit.score >= 0)
+			g_array_append_val (hits, hit);
+		else if (job->fuzzy)
+			g_array_append_val (pending, hit.index);
+	}
 
-				cmd = g_find_program_in_path (argv[0]);
+	if (pending->len > 0 && hits->len >= job->page_size) {
+		SearchPage *page = g_slice_new0 (SearchPage);
 
-				if (cmd && g_stat (cmd, &stat_buf) == 0) {
-					/* 블랙리스트 처리된 앱은 실행권한이 없음 */
-					has_exec_perm = !(stat_buf.st_mode & S_IXOTH);
-				}
-				g_free (cmd);
-			}
-			g_strfreev (argv);
-		}
+		page->task = g_object_ref (task);
+		page->hits = g_array_sized_new (FALSE, FALSE, sizeof (ApplauncherSearchResult), hits->len);
+		g_array_append_vals (page->hits, hits->data, hits->len);
 
-		if (!has_exec_perm) {
-			const gchar *desktop_id = g_desktop_app_info_get_filename (dt_info);
+		g_main_context_invoke_full (g_task_get_context (task),
+                                    G_PRIORITY_DEFAULT,
+                                    search_page_ready_cb,
+                                    page,
+                                    (GDestroyNotify)search_page_free);
+	}
 
-			GKeyFile *keyfile = g_key_file_new ();
+	for (i = 0; i < pending->len; i++) {
+		ApplauncherSearchResult hit;
+		const ApplauncherSearchKey *key;
 
-			/* 블랙리스트 처리된 데스크톱 파일을 저장해서 상태를 변경해야
-             * libgnome-menu 에서 desktop entry 캐쉬를 업데이트한다.*/
-			if (g_key_file_load_from_file (keyfile, desktop_id,
-                                           G_KEY_FILE_KEEP_COMMENTS | G_KEY_FILE_KEEP_TRANSLATIONS,
-                                           NULL)) {
-				g_key_file_save_to_file (keyfile, desktop_id, NULL);
-			}
+		if (i % SEARCH_CANCEL_CHECK_INTERVAL == 0 && g_task_return_error_if_cancelled (task))
+			goto out;
 
-			g_key_file_free (keyfile);
-		}
+		hit.index = g_array_index (pending, guint, i);
+		key = applauncher_search_index_get_key (job->index, hit.index);
+		hit.score = applauncher_search_key_score (key, job->key, TRUE);
+		if (hit.score >= 0)
+			g_array_append_val (hits, hit);
+	}
 
-		g_object_unref (dt_info);
-    }
+	g_task_return_pointer (task, g_array_ref (hits), (GDestroyNotify)g_array_unref);
 
-	g_list_free_full (all_apps, g_object_unref);
+out:
+	g_array_unref (pending);
+	g_array_unref (hits);
 }
 
-static int
-get_total_pages (ApplauncherWindow *window, GSList *list)
+static void
+cancel_search (ApplauncherWindow *window)
 {
 	ApplauncherWindowPrivate *priv = window->priv;
 
-	guint size = 0;
-	gint  num_pages = 0;
-
-	size = g_slist_length (list);
-
-	if (size > 0 && priv->grid_x > 0 && priv->grid_y > 0) {
-		num_pages = (int)(size / (priv->grid_y * priv->grid_x));
-
-		if ((size %  (priv->grid_y * priv->grid_x)) > 0) {
-			num_pages += 1;
-		}
+	if (priv->search_cancellable) {
+		g_cancellable_cancel (priv->search_cancellable);
+		g_clear_object (&priv->search_cancellable);
 	}
 
-	return num_pages;
+	priv->search_task = NULL;
+	priv->search_delivered = 0;
 }
 
+/* hits 의 from 번째부터를 filtered_apps 뒤에 덧붙인다. */
 static void
-update_pages (ApplauncherWindow *window)
+append_search_hits (ApplauncherWindow *window,
+                    GArray            *hits,
+                    guint              from)
 {
+	guint i;
 	ApplauncherWindowPrivate *priv = window->priv;
 
-	g_return_if_fail (priv->filtered_apps != NULL);
+	for (i = from; i < hits->len; i++) {
+		ApplauncherSearchResult *hit = &g_array_index (hits, ApplauncherSearchResult, i);
+		ApplauncherCatalogEntry *entry = g_ptr_array_index (priv->apps, hit->index);
 
-	guint size = 0;
-	gint filtered_pages = 0;
+		entry->search_score = hit->score;
+		entry->launch_score = priv->history ? applauncher_history_get_score (priv->history, entry->path) : 0;
+		g_ptr_array_add (priv->filtered_apps, entry);
+	}
 
-	size = g_slist_length (priv->filtered_apps);
-	filtered_pages = (int)(size / (priv->grid_y * priv->grid_x));
+	priv->search_delivered = hits->len;
+}
 
-	if ((size %  (priv->grid_y * priv->grid_x)) > 0) {
-		filtered_pages += 1;
-	}
+static void
+show_filtered_apps (ApplauncherWindow *window)
+{
+	ApplauncherWindowPrivate *priv = window->priv;
 
-	// Update pages
-	if (filtered_pages > 1) {
+	int total_pages = get_total_pages (window, priv->filtered_apps->len);
+	if (total_pages > 1) {
 		gtk_stack_set_visible_child_name (GTK_STACK (priv->stk_bottom), "indicator");
-		GList *children = applauncher_indicator_get_children (priv->pages);
-		guint total_pages = g_list_length (children);
-
-		int p;
-		for (p = 1; p <= total_pages; p++) {
-			GtkWidget *child = g_list_nth_data (children, p - 1);
-			if (child) {
-				gboolean visible = (p > filtered_pages) ? FALSE : TRUE;
-				gtk_widget_set_visible (child, visible);
-			}
-		}
+		applauncher_indicator_set_active (priv->pages, 0);
 	} else {
 		gtk_stack_set_visible_child_name (GTK_STACK (priv->stk_bottom), "fake");
+		update_grid (window);
 	}
 }
 
+static void activate_first_app (ApplauncherWindow *window);
+
+static gboolean
+search_page_ready_cb (gpointer data)
+{
+	SearchPage *page = data;
+	ApplauncherWindow *window = g_task_get_source_object (page->task);
+	ApplauncherWindowPrivate *priv = window->priv;
+
+	/* 그 사이에 새 검색이 시작되었거나 이미 전체 결과를 받았다. */
+	if (priv->search_task != page->task || priv->search_delivered > 0)
+		return G_SOURCE_REMOVE;
+
+	g_ptr_array_set_size (priv->filtered_apps, 0);
+	priv->ranked_apps = 0;
+	append_search_hits (window, page->hits, 0);
+
+	show_filtered_apps (window);
+
+	return G_SOURCE_REMOVE;
+}
+
 static void
-update_grid (ApplauncherWindow *window)
+search_done_cb (GObject      *source_object,
+                GAsyncResult *result,
+                gpointer      data)
 {
+	GArray *hits;
+	SearchJob *job = g_task_get_task_data (G_TASK (result));
+	ApplauncherWindow *window = APPLAUNCHER_WINDOW (source_object);
 	ApplauncherWindowPrivate *priv = window->priv;
 
-	gint r, c;
-	if (priv->filtered_apps == NULL) {
-		for (r = 0; r < priv->grid_x; r++) {
-			for (c = 0; c < priv->grid_y; c++) {
-				gint pos = c + (r * priv->grid_y);
-				ApplauncherAppItem *item = g_list_nth_data (priv->grid_children, pos);
-				if (item) {
-					gtk_widget_set_sensitive (GTK_WIDGET (item), FALSE);
-					applauncher_appitem_change_app (item, NULL, NULL, NULL, NULL);
-				}
-			}
-		}
+	/* 새 검색어로 대체되어 취소된 경우에만 실패한다. */
+	hits = g_task_propagate_pointer (G_TASK (result), NULL);
+	if (!hits || priv->search_task != G_TASK (result)) {
+		if (hits)
+			g_array_unref (hits);
 		return;
 	}
 
-	GtkIconTheme *icon_theme = gtk_icon_theme_get_default ();
-
-	gint active = applauncher_indicator_get_active (priv->pages);
-	gint item_iter = active * priv->grid_y * priv->grid_x;
-
-	for (r = 0; r < priv->grid_x; r++) {
-		for (c = 0; c < priv->grid_y; c++) {
-			gint pos = c + (r * priv->grid_y); // position in table right now
-			ApplauncherAppItem *item = g_list_nth_data (priv->grid_children, pos);
-			gtk_widget_set_state_flags (GTK_WIDGET (item), GTK_STATE_FLAG_NORMAL, TRUE);
-			if (item_iter < g_slist_length (priv->filtered_apps)) {
-				GMenuTreeEntry *entry = g_slist_nth_data (priv->filtered_apps, item_iter);
-
-				if (!entry) {
-					item_iter++;
-					gtk_widget_set_sensitive (GTK_WIDGET (item), FALSE);
-					continue;
-				}
-
-				GDesktopAppInfo *dt_info = gmenu_tree_entry_get_app_info (entry);
-
-				if (!dt_info) {
-					item_iter++;
-					gtk_widget_set_sensitive (GTK_WIDGET (item), FALSE);
-					continue;
-				}
-
-				GIcon *icon = g_app_info_get_icon (G_APP_INFO (dt_info));
-				const gchar *name = g_app_info_get_name (G_APP_INFO (dt_info));
-				const gchar *desc = g_app_info_get_description (G_APP_INFO (dt_info));
-				const gchar *desktop_id = g_desktop_app_info_get_filename (dt_info);
-
-				gtk_widget_set_sensitive (GTK_WIDGET (item), TRUE);
-				if (desc == NULL || g_strcmp0 (desc, "") == 0) {
-					applauncher_appitem_change_app (item, icon, name, name, desktop_id);
-				} else {
-					gchar *tooltip = g_strdup_printf ("%s:\n%s", name, desc);
-					applauncher_appitem_change_app (item, icon, name, tooltip, desktop_id);
-					g_free (tooltip);
-				}
-			} else { // fill with a blank one
-				gtk_widget_set_sensitive (GTK_WIDGET (item), FALSE);
-				applauncher_appitem_change_app (item, NULL, NULL, NULL, NULL);
-			}
+	if (job->cacheable && priv->search_cache)
+		applauncher_search_cache_insert (priv->search_cache, job->generation,
+                                         job->directory, job->key, hits);
 
-			item_iter++;
-		}
+	if (priv->search_delivered > 0) {
+		/* 보여준 첫 페이지 뒤에 퍼지 일치만 덧붙이므로 정렬된 앞부분은 그대로이다. */
+		append_search_hits (window, hits, priv->search_delivered);
+		update_pages (window);
+	} else {
+		g_ptr_array_set_size (priv->filtered_apps, 0);
+		priv->ranked_apps = 0;
+		append_search_hits (window, hits, 0);
+		show_filtered_apps (window);
 	}
 
-	// Update number of pages
-	update_pages (window);
-}
+	g_array_unref (hits);
 
-static void
-pages_activate_cb (ApplauncherIndicator *indicator, gpointer data)
-{
-	ApplauncherWindow *window = APPLAUNCHER_WINDOW (data);
+	priv->search_task = NULL;
+	g_clear_object (&priv->search_cancellable);
 
-	update_grid (window);
+	if (priv->activate_pending) {
+		priv->activate_pending = FALSE;
+		activate_first_app (window);
+	}
 }
 
-static void
-do_search (ApplauncherWindow *window)
+/* 검색을 시작한다. 결과를 검색 스레드에서 받아야 하면 TRUE 를 돌려준다. */
+static gboolean
+filter_apps (ApplauncherWindow *window)
 {
 	ApplauncherWindowPrivate *priv = window->priv;
 
-	GSList *l = NULL, *apps = NULL;
-	for (l = priv->cur_apps; l; l = l->next) {
-		GMenuTreeEntry *entry = (GMenuTreeEntry *)l->data;
-		if (!entry) continue;
+	guint i;
+	GTask *task;
+	SearchJob *job;
+	GArray *cached;
+	gboolean cacheable;
+	ApplauncherSearchIndex *index = NULL;
+	const ApplauncherBitset *match_set = NULL, *hangul_set = NULL;
 
-		GDesktopAppInfo *dt_info = gmenu_tree_entry_get_app_info (entry);
-		if (!dt_info) continue;
+	cancel_search (window);
 
-		if (g_str_equal (priv->filter_text, "")) {
-			if (!find_entry (apps, entry))
-				apps = g_slist_append (apps, entry);
-		} else {
-			const gchar *id = g_app_info_get_id (G_APP_INFO (dt_info));
-			if (match_desktop (id, priv->filter_text)) {
-				if (!find_entry (apps, entry))
-					apps = g_slist_append (apps, entry);
+	g_free (priv->filter_key);
+	priv->filter_key = applauncher_search_normalize (priv->filter_text);
 
-				continue;
+	g_free (priv->hangul_key);
+	priv->hangul_key = applauncher_hangul_expand_query (priv->filter_key);
+
+	if (priv->catalog)
+		index = applauncher_catalog_get_search_index (priv->catalog);
+
+	/* 검색하지 않을 때는 카탈로그 순서 그대로이다. cur_apps 는 이미 중복이 제거되어 있다. */
+	if (!index || !priv->filter_text || g_str_equal (priv->filter_text, "")) {
+		applauncher_search_session_reset (priv->search);
+		applauncher_search_session_reset (priv->hangul_search);
+
+		g_ptr_array_set_size (priv->filtered_apps, 0);
+		for (i = 0; i < priv->cur_apps->len; i++)
+			g_ptr_array_add (priv->filtered_apps, g_ptr_array_index (priv->cur_apps, i));
+		priv->ranked_apps = priv->filtered_apps->len;
+
+		return FALSE;
+	}
+
+	/* desktop id 일치는 정규화하기 전의 검색어에 달려 있으므로 캐시하지 않는다. */
+	cacheable = (priv->search_cache && priv->filter_key &&
+                 !g_str_has_suffix (priv->filter_text, ".desktop"));
+
+	/* 같은 검색어를 다시 입력하면 일치 여부를 확인하지 않고 바로 보여준다. */
+	if (cacheable) {
+		cached = applauncher_search_cache_lookup (priv->search_cache,
+                                                  applauncher_catalog_get_generation (priv->catalog),
+                                                  priv->cur_dir_pos,
+                                                  priv->filter_key);
+		if (cached) {
+			g_ptr_array_set_size (priv->filtered_apps, 0);
+			priv->ranked_apps = 0;
+			append_search_hits (window, cached, 0);
+			g_array_unref (cached);
+
+			return FALSE;
+		}
+	}
+
+	/* 색인 조회는 이전 결과를 다시 쓰므로 가볍다. 점수 계산만 검색 스레드에서 한다. */
+	if (!priv->filter_key || *priv->filter_key == '\0')
+		applauncher_search_session_reset (priv->search);
+	else
+		match_set = applauncher_search_session_run (priv->search, index, priv->filter_key);
+
+	if (!priv->hangul_key)
+		applauncher_search_session_reset (priv->hangul_search);
+	else
+		hangul_set = applauncher_search_session_run (priv->hangul_search, index, priv->hangul_key);
+
+	job = g_slice_new0 (SearchJob);
+	job->index = applauncher_search_index_ref (index);
+	job->candidates = g_array_ref (priv->cur_indices);
+	job->match_set = copy_match_set (match_set);
+	job->hangul_set = copy_match_set (hangul_set);
+	job->key = g_strdup (priv->filter_key);
+	job->hangul_key = g_strdup (priv->hangul_key);
+	job->page_size = MAX (priv->grid_x * priv->grid_y, 1);
+	job->cacheable = cacheable;
+	job->generation = applauncher_catalog_get_generation (priv->catalog);
+	job->directory = priv->cur_dir_pos;
+
+	/* 한 글자로는 거의 모든 이름이 퍼지 일치하므로 두 글자부터 시도한다. */
+	job->fuzzy = (job->key && g_utf8_strlen (job->key, -1) >= 2);
+
+	/* desktop id 는 항상 .desktop 으로 끝나므로 대부분의 검색어에서는 비교하지 않는다. */
+	job->id_pos = -1;
+	if (g_str_has_suffix (priv->filter_text, ".desktop")) {
+		for (i = 0; i < priv->cur_apps->len; i++) {
+			ApplauncherCatalogEntry *entry = g_ptr_array_index (priv->cur_apps, i);
+
+			if (entry->desktop_id && g_str_equal (entry->desktop_id, priv->filter_text)) {
+				job->id_pos = i;
+				break;
 			}
 		}
 	}
 
-	g_slist_free (priv->filtered_apps);
-	priv->filtered_apps = apps;
+	priv->search_cancellable = g_cancellable_new ();
 
-	int total_pages = get_total_pages (window, priv->filtered_apps);
-	if (total_pages > 1) {
-		gtk_stack_set_visible_child_name (GTK_STACK (priv->stk_bottom), "indicator");
-		applauncher_indicator_set_active (priv->pages, 0);
-	} else {
-		gtk_stack_set_visible_child_name (GTK_STACK (priv->stk_bottom), "fake");
-		update_grid (window);
+	task = g_task_new (window, priv->search_cancellable, search_done_cb, NULL);
+	g_task_set_source_tag (task, filter_apps);
+	g_task_set_task_data (task, job, (GDestroyNotify)search_job_free);
+	g_task_run_in_thread (task, search_thread);
+
+	priv->search_task = task;
+	g_object_unref (task);
+
+	return TRUE;
+}
+
+static void
+do_search (ApplauncherWindow *window)
+{
+	ApplauncherWindowPrivate *priv = window->priv;
+
+	/* 결과를 기다리는 동안에는 이전 결과를 그대로 보여준다. */
+	if (filter_apps (window))
+		return;
+
+	show_filtered_apps (window);
+
+	if (priv->activate_pending) {
+		priv->activate_pending = FALSE;
+		activate_first_app (window);
 	}
 }
 
@@ -683,22 +823,22 @@ appitem_button_clicked_cb (GtkButton *button, gpointer data)
 
 	priv->selected_appitem = button;
 
-	gint index = g_list_index (priv->grid_children, button);
+	gint index = GPOINTER_TO_INT (g_object_get_data (G_OBJECT (button), "cell-index"));
 
 	if (index < 0)
 		return;
 
 	gint active = applauncher_indicator_get_active (priv->pages);
-	gint pos = index + (active * priv->grid_y * priv->grid_x);
+	guint pos = index + (active * priv->grid_y * priv->grid_x);
 
-	GMenuTreeEntry *entry = g_slist_nth_data (priv->filtered_apps, pos);
-	if (!entry)
+	if (pos >= priv->filtered_apps->len)
 		return;
 
-	GDesktopAppInfo *dt_info = gmenu_tree_entry_get_app_info (entry);
-	const gchar *desktop_id = g_desktop_app_info_get_filename (dt_info);
+	ApplauncherCatalogEntry *entry = g_ptr_array_index (priv->filtered_apps, pos);
+	if (!entry)
+		return;
 
-	g_signal_emit (G_OBJECT (window), signals[LAUNCH_DESKTOP], 0, desktop_id);
+	g_signal_emit (G_OBJECT (window), signals[LAUNCH_DESKTOP], 0, entry->path);
 }
 
 static void
@@ -738,31 +878,6 @@ on_search_entry_changed_cb (ApplauncherWindow *window)
                                    search_entry_changed_idle_destroyed);
 }
 
-static void
-on_search_entry_preedit_changed_cb (GtkEntry *entry,
-                                    gchar    *preedit,
-                                    gpointer  data)
-{
-	const gchar *text;
-	ApplauncherWindowPrivate *priv = window->priv;
-
-	if (priv->idle_entry_changed_id != 0) {
-		g_source_remove (priv->idle_entry_changed_id);
-		priv->idle_entry_changed_id = 0;
-	}
-
-	text = gtk_entry_get_text (GTK_ENTRY (priv->ent_search));
-
-	g_clear_pointer (&priv->filter_text, g_free);
-	priv->filter_text = (text == NULL) ? g_strdup ("") : g_strdup (text);
-
-	priv->idle_entry_changed_id =
-		gdk_threads_add_idle_full (G_PRIORITY_DEFAULT,
-                                   search_entry_changed_idle,
-                                   window,
-                                   search_entry_changed_idle_destroyed);
-}
-
 static void
 on_search_entry_preedit_changed_cb (GtkEntry *entry,
                                     gchar    *preedit,
@@ -809,13 +924,11 @@ search_entry_button_press_cb (GtkWidget      *widget,
 
 
 static void
-on_search_entry_activate_cb (GtkEditable *entry,
-                             gpointer     data)
+activate_first_app (ApplauncherWindow *window)
 {
-	ApplauncherWindow *window = APPLAUNCHER_WINDOW (data);
 	ApplauncherWindowPrivate *priv = window->priv;
 
-	guint size = g_slist_length (priv->filtered_apps);
+	guint size = priv->filtered_apps->len;
 	if (size == 0) return;
 
 	GtkWidget *focus = gtk_container_get_focus_child (GTK_CONTAINER (priv->grid));
@@ -825,7 +938,9 @@ on_search_entry_activate_cb (GtkEditable *entry,
 		return;
 	}
 
-	ApplauncherAppItem *item = g_list_nth_data (priv->grid_children, 0);
+	if (priv->grid_children->len == 0) return;
+
+	ApplauncherAppItem *item = g_ptr_array_index (priv->grid_children, 0);
 
 	gtk_widget_grab_focus (GTK_WIDGET (item));
 	if (size == 1) {
@@ -833,6 +948,22 @@ on_search_entry_activate_cb (GtkEditable *entry,
 	}
 }
 
+static void
+on_search_entry_activate_cb (GtkEditable *entry,
+                             gpointer     data)
+{
+	ApplauncherWindow *window = APPLAUNCHER_WINDOW (data);
+	ApplauncherWindowPrivate *priv = window->priv;
+
+	/* 입력한 검색어의 결과가 아직 없으면 결과가 온 뒤에 실행한다. */
+	if (priv->idle_entry_changed_id != 0 || priv->search_task) {
+		priv->activate_pending = TRUE;
+		return;
+	}
+
+	activate_first_app (window);
+}
+
 static void
 on_search_entry_icon_release_cb (GtkEntry             *entry,
                                  GtkEntryIconPosition  icon_pos,
@@ -854,209 +985,377 @@ directory_changed_idle_destroyed (gpointer data)
 static gboolean
 directory_changed_idle (gpointer data)
 {
-	ApplauncherWindow *window = APPLAUNCHER_WINDOW (data);
+	ApplauncherWindow *window = APPLAUNCHER_WINDOW (data);
+	ApplauncherWindowPrivate *priv = window->priv;
+
+	gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (priv->cur_dir_button), TRUE);
+
+	return FALSE;
+}
+
+static gboolean
+on_directory_item_enter_notify_event_cb (GtkWidget     *widget,
+                                         GdkEventFocus *event,
+                                         gpointer       data)
+{
+	ApplauncherWindow *window = APPLAUNCHER_WINDOW (data);
+	ApplauncherWindowPrivate *priv = window->priv;
+
+	priv->cur_dir_button = widget;
+
+	if (priv->idle_directory_changed_id != 0) {
+		g_source_remove (priv->idle_directory_changed_id);
+		priv->idle_directory_changed_id = 0;
+	}
+
+	priv->idle_directory_changed_id =
+		gdk_threads_add_timeout_full (G_PRIORITY_DEFAULT,
+                                      300,
+                                      directory_changed_idle,
+                                      window,
+                                      directory_changed_idle_destroyed);
+
+	return FALSE;
+}
+
+static gboolean
+on_directory_item_leave_notify_event_cb (GtkWidget     *widget,
+                                         GdkEventFocus *event,
+                                         gpointer       data)
+{
+	ApplauncherWindow *window = APPLAUNCHER_WINDOW (data);
+	ApplauncherWindowPrivate *priv = window->priv;
+
+	if (priv->idle_directory_changed_id != 0) {
+		g_source_remove (priv->idle_directory_changed_id);
+		priv->idle_directory_changed_id = 0;
+	}
+
+	return FALSE;
+}
+
+static ApplauncherCatalogDirectory *
+get_directory_for_button (ApplauncherWindow *window,
+                          GtkWidget         *button)
+{
+	ApplauncherWindowPrivate *priv = window->priv;
+
+	guint pos = 0;
+	GList *children, *l = NULL;
+	ApplauncherCatalogDirectory *dir = NULL;
+
+	children = gtk_container_get_children (GTK_CONTAINER (priv->lbx_dirs));
+
+	for (l = children; l; l = l->next) {
+		if (button == GTK_WIDGET (l->data)) {
+			if (priv->dirs && pos < priv->dirs->len)
+				dir = g_ptr_array_index (priv->dirs, pos);
+			break;
+		}
+
+		pos++;
+	}
+	g_list_free (children);
+
+	return dir;
+}
+
+/* 진행 중인 검색을 취소하고 목록을 비운다. */
+static void
+clear_cur_apps (ApplauncherWindow *window)
+{
 	ApplauncherWindowPrivate *priv = window->priv;
 
-	gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (priv->cur_dir_button), TRUE);
+	cancel_search (window);
+	priv->activate_pending = FALSE;
 
-	return FALSE;
+	g_ptr_array_set_size (priv->filtered_apps, 0);
+	g_ptr_array_set_size (priv->cur_apps, 0);
+	priv->ranked_apps = 0;
+	g_hash_table_remove_all (priv->seen_names);
+
+	g_array_unref (priv->cur_indices);
+	priv->cur_indices = g_array_new (FALSE, FALSE, sizeof (guint));
 }
 
-static gboolean
-on_directory_item_enter_notify_event_cb (GtkWidget     *widget,
-                                         GdkEventFocus *event,
-                                         gpointer       data)
+/* 자주 실행한 항목들을 cur_apps 맨 앞, 그리드의 첫 줄로 옮긴다.
+ * 검색 작업이 cur_indices 의 위치를 cur_apps 의 위치로 쓰므로 같은 순서로 다시 만든다.
+ * 그리드는 grid_y 개의 열로 채워지므로 첫 줄의 칸 수는 grid_y 이다. */
+static void
+promote_frequent_apps (ApplauncherWindow *window)
 {
-	ApplauncherWindow *window = APPLAUNCHER_WINDOW (data);
+	guint i;
+	GPtrArray *frequent, *rest;
+	GHashTable *ranks;
+	ApplauncherCatalogEntry **front;
 	ApplauncherWindowPrivate *priv = window->priv;
 
-	priv->cur_dir_button = widget;
+	if (!priv->history || priv->grid_y <= 0)
+		return;
 
-	if (priv->idle_directory_changed_id != 0) {
-		g_source_remove (priv->idle_directory_changed_id);
-		priv->idle_directory_changed_id = 0;
+	priv->history_serial = applauncher_history_get_serial (priv->history);
+
+	frequent = applauncher_history_get_frequent (priv->history, priv->grid_y);
+	if (frequent->len == 0) {
+		g_ptr_array_unref (frequent);
+		return;
 	}
 
-	priv->idle_directory_changed_id =
-		gdk_threads_add_timeout_full (G_PRIORITY_DEFAULT,
-                                      300,
-                                      directory_changed_idle,
-                                      window,
-                                      directory_changed_idle_destroyed);
+	ranks = g_hash_table_new (g_str_hash, g_str_equal);
+	for (i = 0; i < frequent->len; i++)
+		g_hash_table_insert (ranks, g_ptr_array_index (frequent, i), GUINT_TO_POINTER (i + 1));
 
-	return FALSE;
+	front = g_new0 (ApplauncherCatalogEntry *, frequent->len);
+	rest = g_ptr_array_sized_new (priv->cur_apps->len);
+
+	for (i = 0; i < priv->cur_apps->len; i++) {
+		ApplauncherCatalogEntry *entry = g_ptr_array_index (priv->cur_apps, i);
+		guint rank = entry->path ? GPOINTER_TO_UINT (g_hash_table_lookup (ranks, entry->path)) : 0;
+
+		if (rank > 0)
+			front[rank - 1] = entry;
+		else
+			g_ptr_array_add (rest, entry);
+	}
+
+	g_ptr_array_set_size (priv->cur_apps, 0);
+	for (i = 0; i < frequent->len; i++) {
+		if (front[i])
+			g_ptr_array_add (priv->cur_apps, front[i]);
+	}
+	for (i = 0; i < rest->len; i++)
+		g_ptr_array_add (priv->cur_apps, g_ptr_array_index (rest, i));
+
+	g_array_unref (priv->cur_indices);
+	priv->cur_indices = g_array_sized_new (FALSE, FALSE, sizeof (guint), priv->cur_apps->len);
+	for (i = 0; i < priv->cur_apps->len; i++) {
+		ApplauncherCatalogEntry *entry = g_ptr_array_index (priv->cur_apps, i);
+		g_array_append_val (priv->cur_indices, entry->index);
+	}
+
+	g_ptr_array_unref (rest);
+	g_free (front);
+	g_hash_table_destroy (ranks);
+	g_ptr_array_unref (frequent);
 }
 
-static gboolean
-on_directory_item_leave_notify_event_cb (GtkWidget     *widget,
-                                         GdkEventFocus *event,
-                                         gpointer       data)
+static void
+set_directory_apps (ApplauncherWindow           *window,
+                    ApplauncherCatalogDirectory *dir)
 {
-	ApplauncherWindow *window = APPLAUNCHER_WINDOW (data);
+	gint index;
+	guint pos;
 	ApplauncherWindowPrivate *priv = window->priv;
 
-	if (priv->idle_directory_changed_id != 0) {
-		g_source_remove (priv->idle_directory_changed_id);
-		priv->idle_directory_changed_id = 0;
+	clear_cur_apps (window);
+
+	for (pos = 0; pos < priv->dirs->len; pos++) {
+		if (g_ptr_array_index (priv->dirs, pos) == dir)
+			break;
 	}
+	priv->cur_dir_pos = pos;
 
-	return FALSE;
+	/* 디렉토리 소속과 블랙리스트를 비트 단위로 걸러낸 뒤 순서대로 담는다. */
+	applauncher_bitset_copy (priv->cur_set, dir->member_set);
+	applauncher_bitset_and (priv->cur_set, applauncher_catalog_get_visible (priv->catalog));
+
+	for (index = applauncher_bitset_next (priv->cur_set, -1);
+         index >= 0;
+         index = applauncher_bitset_next (priv->cur_set, index)) {
+		ApplauncherCatalogEntry *entry = g_ptr_array_index (priv->apps, index);
+
+		if (add_unique_entry (window, entry)) {
+			g_ptr_array_add (priv->cur_apps, entry);
+			g_array_append_val (priv->cur_indices, entry->index);
+		}
+	}
+
+	/* 전체 프로그램은 첫 디렉토리이다. */
+	if (pos == 0)
+		promote_frequent_apps (window);
+
+	for (pos = 0; pos < priv->cur_apps->len; pos++)
+		g_ptr_array_add (priv->filtered_apps, g_ptr_array_index (priv->cur_apps, pos));
+
+	priv->ranked_apps = priv->filtered_apps->len;
 }
 
 static void
-on_directory_item_toggled_cb (GtkToggleButton *button,
-                              gpointer         data)
+show_directory (ApplauncherWindow *window,
+                GtkWidget         *button)
 {
-	ApplauncherWindow *window = APPLAUNCHER_WINDOW (data);
 	ApplauncherWindowPrivate *priv = window->priv;
 
-	gint pos = 0;
-	GList *children, *l = NULL;
-	GMenuTreeDirectory *cur_dir = NULL;
+	ApplauncherCatalogDirectory *cur_dir = NULL;
 
 	if (priv->idle_directory_changed_id != 0) {
 		g_source_remove (priv->idle_directory_changed_id);
 		priv->idle_directory_changed_id = 0;
 	}
 
-	children = gtk_container_get_children (GTK_CONTAINER (priv->lbx_dirs));
-
-	for (l = children; l; l = l->next) {
-		GtkWidget *child = GTK_WIDGET (l->data);
-
-		if (GTK_WIDGET (button) == GTK_WIDGET (l->data)) {
-			cur_dir = g_slist_nth_data (priv->dirs, pos);
-			break;
-		}
+	cur_dir = get_directory_for_button (window, button);
 
-		pos++;
+	if (cur_dir) {
+		set_directory_apps (window, cur_dir);
+		show_filtered_apps (window);
 	}
+}
 
-	if (cur_dir) {
-		GSList *list = get_all_applications_from_dir (cur_dir, NULL);
+static void
+on_directory_item_toggled_cb (GtkToggleButton *button,
+                              gpointer         data)
+{
+	/* 라디오 그룹에서 해제되는 버튼의 시그널은 무시한다. */
+	if (!gtk_toggle_button_get_active (button))
+		return;
 
-		g_slist_free (priv->filtered_apps);
-		g_slist_free (priv->cur_apps);
-		priv->filtered_apps = NULL;
-		priv->cur_apps = NULL;
+	show_directory (APPLAUNCHER_WINDOW (data), GTK_WIDGET (button));
+}
 
-		GSList *l = NULL;
-		for (l = list; l; l = l->next) {
-			if (!find_entry (priv->filtered_apps, l->data)) {
-				priv->filtered_apps = g_slist_append (priv->filtered_apps, l->data);
-				priv->cur_apps = g_slist_append (priv->cur_apps, l->data);
-			}
-		}
+static void
+invalidate_layout_cache (ApplauncherWindow *window)
+{
+	ApplauncherWindowPrivate *priv = window->priv;
 
-		int total_pages = get_total_pages (window, priv->filtered_apps);
-		if (total_pages > 1) {
-			gtk_stack_set_visible_child_name (GTK_STACK (priv->stk_bottom), "indicator");
-			applauncher_indicator_set_active (priv->pages, 0);
-		} else {
-			gtk_stack_set_visible_child_name (GTK_STACK (priv->stk_bottom), "fake");
-			update_grid (window);
-		}
-	}
+	priv->layout_item_size = 0;
+	priv->layout_rows = -1;
+	priv->layout_cols = -1;
 }
 
-static gint
-get_default_size_of_appitem (ApplauncherWindow *window)
+/* 한 줄 이름과 두 줄 이름을 가진 항목을 한 번씩만 만들어 크기를 잰다.
+ * 이름의 줄 수는 같은 글꼴의 Pango 레이아웃으로 계산한다. */
+static void
+measure_appitem_probe (ApplauncherWindow *window)
 {
-	gint max_item_size = 0;
+	GIcon *icon = NULL;
+	gint width = 0;
+	GDesktopAppInfo *dt_info;
+	ApplauncherAppItem *item;
+	ApplauncherWindowPrivate *priv = window->priv;
 
-	GDesktopAppInfo *dt_info = g_desktop_app_info_new_from_filename (DUMMY_DESKTOP);
+	dt_info = g_desktop_app_info_new_from_filename (DUMMY_DESKTOP);
+	if (dt_info)
+		icon = g_app_info_get_icon (G_APP_INFO (dt_info));
 
-	if (dt_info) {
-		GIcon *icon = g_app_info_get_icon (G_APP_INFO (dt_info));
-		const gchar *name = g_app_info_get_name (G_APP_INFO (dt_info));
-		const gchar *desktop_id = g_desktop_app_info_get_filename (dt_info);
+	item = applauncher_appitem_new (priv->icon_size, priv->icon_cache);
+	gtk_widget_show (GTK_WIDGET (item));
 
-		ApplauncherAppItem *item = applauncher_appitem_new (window->priv->icon_size);
-		applauncher_appitem_change_app (item, icon, name, NULL, desktop_id);
-		gtk_widget_show (GTK_WIDGET (item));
+	gtk_grid_attach (GTK_GRID (priv->grid), GTK_WIDGET (item), 0, 0, 1, 1);
 
-		gtk_grid_attach (GTK_GRID (window->priv->grid), GTK_WIDGET (item), 0, 0, 1, 1);
+	applauncher_appitem_change_app (item, icon, "A", NULL, NULL);
+	gtk_widget_get_preferred_width (GTK_WIDGET (item), NULL, &priv->probe_width);
+	gtk_widget_get_preferred_height (GTK_WIDGET (item), NULL, &priv->probe_one_line_height);
 
-		gint max = 0, pref_w = 0, pref_h = 0;
-		gtk_widget_get_preferred_width (GTK_WIDGET (item), NULL, &pref_w);
-		gtk_widget_get_preferred_height (GTK_WIDGET (item), NULL, &pref_h);
+	applauncher_appitem_change_app (item, icon, "A\nA", NULL, NULL);
+	gtk_widget_get_preferred_width (GTK_WIDGET (item), NULL, &width);
+	gtk_widget_get_preferred_height (GTK_WIDGET (item), NULL, &priv->probe_two_lines_height);
+	priv->probe_width = MAX (priv->probe_width, width);
 
-		max = (pref_w > pref_h) ? pref_w : pref_h;
-		max_item_size = (max_item_size > max) ? max_item_size: max;
+	g_clear_object (&priv->name_layout);
+	priv->name_layout = gtk_widget_create_pango_layout (GTK_WIDGET (item), NULL);
+	pango_layout_set_width (priv->name_layout, priv->icon_size * PANGO_SCALE);
+	pango_layout_set_wrap (priv->name_layout, PANGO_WRAP_WORD_CHAR);
 
-		gtk_widget_destroy (GTK_WIDGET (item));
-	}
+	gtk_widget_destroy (GTK_WIDGET (item));
+
+	if (dt_info)
+		g_object_unref (dt_info);
 
-	return max_item_size;
+	/* 글꼴이 바뀌면 창 여백도 달라진다. */
+	invalidate_layout_cache (window);
 }
 
 static gint
 get_max_size_of_appitem (ApplauncherWindow *window)
 {
-	GSList *l = NULL;
-	gint max_item_size = 0, item_width = 0, item_height = 0;
-
-	l = window->priv->apps;
+	guint i, generation;
+	gint scale, height;
+	gchar *font;
+	gboolean two_lines = FALSE;
+	PangoContext *context;
+	ApplauncherWindowPrivate *priv = window->priv;
 
-	if (!l) {
-		max_item_size = get_default_size_of_appitem (window);
+	context = gtk_widget_get_pango_context (GTK_WIDGET (window));
+	font = pango_font_description_to_string (pango_context_get_font_description (context));
+	scale = gtk_widget_get_scale_factor (GTK_WIDGET (window));
+	generation = priv->catalog ? applauncher_catalog_get_generation (priv->catalog) : 0;
+
+	if (!priv->name_layout ||
+	    g_strcmp0 (font, priv->item_font) != 0 ||
+	    scale != priv->item_scale ||
+	    priv->icon_size != priv->item_icon_size) {
+		measure_appitem_probe (window);
+
+		g_free (priv->item_font);
+		priv->item_font = g_strdup (font);
+		priv->item_scale = scale;
+		priv->item_icon_size = priv->icon_size;
+	} else if (generation == priv->item_generation && priv->item_size > 0) {
+		g_free (font);
+		return priv->item_size;
 	}
+	g_free (font);
 
-	for (l; l; l = l->next) {
-		GMenuTreeEntry *entry = (GMenuTreeEntry *)l->data;
-		if (entry) {
-			GDesktopAppInfo *dt_info = gmenu_tree_entry_get_app_info (entry);
-			if (dt_info) {
-				GIcon *icon = g_app_info_get_icon (G_APP_INFO (dt_info));
-				const gchar *name = g_app_info_get_name (G_APP_INFO (dt_info));
-				const gchar *desktop_id = g_desktop_app_info_get_filename (dt_info);
-
-				ApplauncherAppItem *item = applauncher_appitem_new (window->priv->icon_size);
-				applauncher_appitem_change_app (item, icon, name, NULL, desktop_id);
-				gtk_widget_show (GTK_WIDGET (item));
+	/* 두 줄로 넘어가는 이름이 하나라도 있으면 두 줄 높이를 사용한다. */
+	for (i = 0; priv->apps && i < priv->apps->len && !two_lines; i++) {
+		ApplauncherCatalogEntry *entry = g_ptr_array_index (priv->apps, i);
 
-				gtk_grid_attach (GTK_GRID (window->priv->grid), GTK_WIDGET (item), 0, 0, 1, 1);
+		if (!entry || entry->blocked || !entry->name)
+			continue;
 
-				gint max = 0, pref_w = 0, pref_h = 0;
-				gtk_widget_get_preferred_width (GTK_WIDGET (item), NULL, &pref_w);
-				gtk_widget_get_preferred_height (GTK_WIDGET (item), NULL, &pref_h);
+		pango_layout_set_text (priv->name_layout, entry->name, -1);
+		two_lines = (pango_layout_get_line_count (priv->name_layout) > 1);
+	}
 
-				max = (pref_w > pref_h) ? pref_w : pref_h;
-				max_item_size = (max_item_size > max) ? max_item_size: max;
+	height = two_lines ? priv->probe_two_lines_height : priv->probe_one_line_height;
 
-				gtk_widget_destroy (GTK_WIDGET (item));
-			}
-		}
-	}
+	priv->item_size = MAX (priv->probe_width, height);
+	priv->item_generation = generation;
 
-	return max_item_size;
+	return priv->item_size;
 }
 
 static void
 populate_dirs (ApplauncherWindow *window)
 {
+	GList *children, *c;
 	ApplauncherWindowPrivate *priv = window->priv;
 
-	GSList *l = NULL;
-	for (l = priv->dirs; l; l = l->next) {
-		GMenuTreeDirectory *dir = (GMenuTreeDirectory *)l->data;
+	children = gtk_container_get_children (GTK_CONTAINER (priv->lbx_dirs));
+	for (c = children; c; c = c->next) {
+		GtkWidget *item = GTK_WIDGET (c->data);
+		g_signal_handlers_disconnect_by_func (item, on_directory_item_enter_notify_event_cb, window);
+		g_signal_handlers_disconnect_by_func (item, on_directory_item_leave_notify_event_cb, window);
+		g_signal_handlers_disconnect_by_func (item, on_directory_item_toggled_cb, window);
+		gtk_widget_destroy (item);
+	}
+	g_list_free (children);
+
+	priv->directory_group = NULL;
+	priv->cur_dir_button = NULL;
+
+	/* 사이드바 폭이 바뀌므로 창 여백을 다시 측정해야 한다. */
+	invalidate_layout_cache (window);
+
+	guint i;
+	for (i = 0; priv->dirs && i < priv->dirs->len; i++) {
+		ApplauncherCatalogDirectory *dir = g_ptr_array_index (priv->dirs, i);
 
 		GIcon *icon;
 		const char *name;
 
-		if (g_str_has_suffix (gmenu_tree_directory_get_desktop_file_path (dir), "chrome-apps.directory"))
-			continue;
-
-		if (gmenu_tree_directory_get_desktop_file_path (dir) != NULL) {
-			icon = gmenu_tree_directory_get_icon (dir);
-			name = gmenu_tree_directory_get_name (dir);
+		if (dir->path != NULL) {
+			icon = dir->icon ? g_icon_new_for_string (dir->icon, NULL) : NULL;
+			name = dir->name;
 		} else {
-			icon = icon = g_themed_icon_new ("applications-other");
+			icon = g_themed_icon_new ("applications-other");
 			name = _("All Programs");
 		}
 
 		GSList *l = NULL;
 		ApplauncherDirectoryItem *item = applauncher_directory_item_new (icon, name);
+		if (icon)
+			g_object_unref (icon);
 		if (priv->directory_group) {
 			l = gtk_radio_button_get_group (priv->directory_group);
 		} else {
@@ -1074,91 +1373,94 @@ populate_dirs (ApplauncherWindow *window)
 	}
 }
 
+/* 그리드를 제외한 창의 여백(사이드바, 검색창 등)을 한 번만 측정한다.
+ * 그리드가 가장 작을 때의 창 크기와 DEFAULT_GRID 크기일 때의 창 크기를 잰다. */
 static void
-get_rows_and_columns (ApplauncherWindow *window,
-                      GdkRectangle      *workarea,
-                      int                item_size,
-                      int               *row,
-                      int               *col)
+measure_window_chrome (ApplauncherWindow *window,
+                       int                item_size)
 {
-	ApplauncherAppItem *item;
-	ApplauncherWindowPrivate *priv = window->priv;
-
-	int size = 0;
-	int c = 0, r = 0;
-	int popup_width, popup_height;
+	int width, height;
 	int row_spacing, col_spacing;
+	ApplauncherWindowPrivate *priv = window->priv;
 
 	row_spacing = gtk_grid_get_row_spacing (GTK_GRID (priv->grid));
 	col_spacing = gtk_grid_get_column_spacing (GTK_GRID (priv->grid));
 
-#if 0
-	size = item_size;
-	for (i = 1; i < DEFAULT_GRID_Y; i++) {
-		gtk_widget_set_size_request (priv->grid, size, -1);
-		gtk_widget_get_preferred_width (GTK_WIDGET (window), NULL, &popup_width);
+	gtk_widget_set_size_request (priv->grid, item_size, item_size);
+	gtk_widget_get_preferred_width (GTK_WIDGET (window), NULL, &priv->min_popup_width);
+	gtk_widget_get_preferred_height (GTK_WIDGET (window), NULL, &priv->min_popup_height);
 
-		if (popup_width >= priv->init_popup_width)
-			break;
-
-		size += (item_size + col_spacing);
-	}
-
-	for (c = i + 1; c < DEFAULT_GRID_Y; c++) {
-		if (popup_width >= workarea->width)
-			break;
-		popup_width += (item_size + col_spacing);
-	}
-
-	if (col) *col = c;
-
-	size = item_size;
-	for (i = 0; i < DEFAULT_GRID_X; i++) {
-		gtk_widget_set_size_request (priv->grid, -1, size);
-		gtk_widget_get_preferred_height (GTK_WIDGET (window), NULL, &popup_height);
+	width = item_size + (item_size + col_spacing) * (DEFAULT_GRID_Y - 1);
+	height = item_size + (item_size + row_spacing) * (DEFAULT_GRID_X - 1);
 
-		if (popup_height >= priv->init_popup_height)
-			break;
-
-		size += (item_size + row_spacing);
-	}
-
-	for (r = i + 1; r < DEFAULT_GRID_X; r++) {
-		if (popup_height >= workarea->height)
-			break;
-		popup_height += (item_size + row_spacing);
-	}
-
-	if (row) *row = r;
+	gtk_widget_set_size_request (priv->grid, width, height);
+	gtk_widget_get_preferred_width (GTK_WIDGET (window), NULL, &priv->chrome_width);
+	gtk_widget_get_preferred_height (GTK_WIDGET (window), NULL, &priv->chrome_height);
+	priv->chrome_width -= width;
+	priv->chrome_height -= height;
 
 	gtk_widget_set_size_request (priv->grid, 0, 0);
-#endif
 
-	size = item_size;
-	for (c = 0; c < DEFAULT_GRID_Y; c++) {
-		gtk_widget_set_size_request (priv->grid, size, -1);
-		gtk_widget_get_preferred_width (GTK_WIDGET (window), NULL, &popup_width);
+	priv->layout_item_size = item_size;
+	priv->layout_rows = -1;
+	priv->layout_cols = -1;
+}
 
-		if (popup_width >= workarea->width)
-			break;
+/* 창 크기가 작업 영역보다 작게 유지되는 최대 칸 수를 계산한다.
+ * 작업 영역이 아주 작아도 한 칸은 보여준다. */
+static int
+get_grid_count (int avail,
+                int min_popup,
+                int chrome,
+                int item_size,
+                int spacing,
+                int max_count)
+{
+	int step, extent;
 
-		size += (item_size + col_spacing);
-	}
+	if (min_popup >= avail)
+		return 1;
 
-	size = item_size;
-	for (r = 0; r < DEFAULT_GRID_X; r++) {
-		gtk_widget_set_size_request (priv->grid, -1, size);
-		gtk_widget_get_preferred_height (GTK_WIDGET (window), NULL, &popup_height);
+	step = item_size + spacing;
+	extent = avail - chrome + spacing;
+	if (step <= 0 || extent <= 0)
+		return 1;
 
-		if (popup_height >= workarea->height)
-			break;
+	return CLAMP ((extent - 1) / step, 1, MAX (max_count, 1));
+}
+
+static void
+get_rows_and_columns (ApplauncherWindow *window,
+                      GdkRectangle      *workarea,
+                      int                item_size,
+                      int               *row,
+                      int               *col)
+{
+	ApplauncherWindowPrivate *priv = window->priv;
 
-		size += (item_size + row_spacing);
+	if (priv->layout_item_size != item_size)
+		measure_window_chrome (window, item_size);
+
+	if (priv->layout_rows < 0 ||
+	    priv->layout_workarea_width != workarea->width ||
+	    priv->layout_workarea_height != workarea->height) {
+		int row_spacing, col_spacing;
+
+		row_spacing = gtk_grid_get_row_spacing (GTK_GRID (priv->grid));
+		col_spacing = gtk_grid_get_column_spacing (GTK_GRID (priv->grid));
+
+		priv->layout_cols = get_grid_count (workarea->width, priv->min_popup_width,
+                                            priv->chrome_width, item_size,
+                                            col_spacing, DEFAULT_GRID_Y);
+		priv->layout_rows = get_grid_count (workarea->height, priv->min_popup_height,
+                                            priv->chrome_height, item_size,
+                                            row_spacing, DEFAULT_GRID_X);
+		priv->layout_workarea_width = workarea->width;
+		priv->layout_workarea_height = workarea->height;
 	}
-	if (col) *col = c;
-	if (row) *row = r;
 
-	gtk_widget_set_size_request (priv->grid, 0, 0);
+	if (col) *col = priv->layout_cols;
+	if (row) *row = priv->layout_rows;
 }
 
 static gboolean
@@ -1277,13 +1579,13 @@ appitem_button_drag_failed_cb (GtkWidget      *widget,
 static void
 populate_apps (ApplauncherWindow *window, GdkRectangle *workarea)
 {
-	GList *l = NULL;
+	guint i;
 	int r, c, item_size;
 
 	ApplauncherWindowPrivate *priv = window->priv;
 
-	for (l = priv->grid_children; l; l = l->next) {
-		GtkWidget *item = GTK_WIDGET (l->data);
+	for (i = 0; i < priv->grid_children->len; i++) {
+		GtkWidget *item = g_ptr_array_index (priv->grid_children, i);
 		if (item) {
 			g_signal_handlers_disconnect_by_func (item, appitem_button_clicked_cb, window);
 			g_signal_handlers_disconnect_by_func (item, appitem_button_press_event_cb, window);
@@ -1295,8 +1597,7 @@ populate_apps (ApplauncherWindow *window, GdkRectangle *workarea)
 			item = NULL;
 		}
 	}
-	g_list_free (priv->grid_children);
-	priv->grid_children = NULL;
+	g_ptr_array_set_size (priv->grid_children, 0);
 
 	// get max size of items
 	item_size = get_max_size_of_appitem (window);
@@ -1312,12 +1613,14 @@ populate_apps (ApplauncherWindow *window, GdkRectangle *workarea)
 
 	for (r = 0; r < priv->grid_x; r++) {
 		for (c = 0; c < priv->grid_y; c++) {
-			ApplauncherAppItem *item = applauncher_appitem_new (priv->icon_size);
+			ApplauncherAppItem *item = applauncher_appitem_new (priv->icon_size, priv->icon_cache);
 			gtk_widget_set_size_request (GTK_WIDGET (item), item_size, item_size);
 
 			gtk_grid_attach (GTK_GRID (priv->grid), GTK_WIDGET (item), c, r, 1, 1);
 
-			priv->grid_children = g_list_append (priv->grid_children, item);
+			g_object_set_data (G_OBJECT (item), "cell-index",
+                               GINT_TO_POINTER (priv->grid_children->len));
+			g_ptr_array_add (priv->grid_children, item);
 
 			g_signal_connect (G_OBJECT (item), "clicked",
                               G_CALLBACK (appitem_button_clicked_cb), window);
@@ -1357,7 +1660,7 @@ applauncher_window_page_right (ApplauncherWindow *window)
 {
 	ApplauncherWindowPrivate *priv = window->priv;
 
-	gint total_pages = get_total_pages (window, priv->filtered_apps);
+	gint total_pages = get_total_pages (window, priv->filtered_apps->len);
 	gint active = applauncher_indicator_get_active (priv->pages);
 
 	if ((active + 1) < total_pages) {
@@ -1386,7 +1689,110 @@ applauncher_window_scroll (GtkWidget      *widget,
 static void
 applauncher_window_select_all_programs (ApplauncherWindow *window)
 {
-	on_directory_item_toggled_cb (GTK_TOGGLE_BUTTON (window->priv->cur_dir_button), window);
+	ApplauncherWindowPrivate *priv = window->priv;
+
+	/* 카탈로그를 읽는 중에는 빈 그리드를 보여준다. */
+	if (!priv->cur_dir_button) {
+		clear_cur_apps (window);
+		update_grid (window);
+		return;
+	}
+
+	show_directory (window, priv->cur_dir_button);
+}
+
+static GtkWidget *
+get_active_directory_button (ApplauncherWindow *window)
+{
+	GList *children, *l;
+	GtkWidget *active = NULL;
+	ApplauncherWindowPrivate *priv = window->priv;
+
+	children = gtk_container_get_children (GTK_CONTAINER (priv->lbx_dirs));
+	for (l = children; l; l = l->next) {
+		if (gtk_toggle_button_get_active (GTK_TOGGLE_BUTTON (l->data))) {
+			active = GTK_WIDGET (l->data);
+			break;
+		}
+	}
+	g_list_free (children);
+
+	return active;
+}
+
+/* 보이는 그리드는 그대로 두고 목록과 페이지만 다시 구성한다. */
+static void
+refresh_apps (ApplauncherWindow *window)
+{
+	gint p, page, total_pages;
+	GtkWidget *button;
+	ApplauncherCatalogDirectory *dir = NULL;
+	ApplauncherWindowPrivate *priv = window->priv;
+
+	page = applauncher_indicator_get_active (priv->pages);
+
+	applauncher_indicator_reset (priv->pages);
+	total_pages = get_total_pages (window, priv->apps ? priv->apps->len : 0);
+	for (p = 0; p < total_pages; p++) {
+		applauncher_indicator_append (priv->pages);
+	}
+
+	button = get_active_directory_button (window);
+	if (button)
+		dir = get_directory_for_button (window, button);
+
+	if (!dir) {
+		update_grid (window);
+		return;
+	}
+
+	set_directory_apps (window, dir);
+
+	/* 검색 결과가 오면 첫 페이지부터 보여준다. 그 전에는 보이는 그리드와 맞지 않는
+	 * 항목을 실행하지 않도록 목록을 비워 둔다. */
+	if (filter_apps (window)) {
+		g_ptr_array_set_size (priv->filtered_apps, 0);
+		priv->ranked_apps = 0;
+		return;
+	}
+
+	total_pages = get_total_pages (window, priv->filtered_apps->len);
+	if (total_pages > 0) {
+		applauncher_indicator_set_active (priv->pages, MIN (page, total_pages - 1));
+	} else {
+		gtk_stack_set_visible_child_name (GTK_STACK (priv->stk_bottom), "fake");
+		update_grid (window);
+	}
+}
+
+static void
+catalog_changed_cb (ApplauncherCatalog *catalog,
+                    gboolean            directories_changed,
+                    gpointer            data)
+{
+	ApplauncherWindow *window = APPLAUNCHER_WINDOW (data);
+	ApplauncherWindowPrivate *priv = window->priv;
+
+	/* 이전 항목은 시그널이 끝나면 해제되므로 먼저 목록을 비운다. */
+	clear_cur_apps (window);
+	applauncher_search_session_reset (priv->search);
+	applauncher_search_session_reset (priv->hangul_search);
+
+	priv->dirs = applauncher_catalog_get_directories (catalog);
+	priv->apps = applauncher_catalog_get_entries (catalog);
+
+	if (directories_changed)
+		populate_dirs (window);
+
+	/* 아직 realize 되지 않았다면 realize 에서 그리드를 구성한다. */
+	if (!gtk_widget_get_realized (GTK_WIDGET (window)))
+		return;
+
+	/* 디렉토리가 바뀌면 전체 프로그램부터 다시 보여준다. */
+	if (directories_changed || priv->grid_children->len == 0)
+		applauncher_window_reload_apps (window, &priv->workarea);
+	else
+		refresh_apps (window);
 }
 
 static gboolean
@@ -1526,18 +1932,50 @@ applauncher_window_init (ApplauncherWindow *window)
 	gtk_widget_init_template (GTK_WIDGET (window));
 
 	priv->directory_group = NULL;
+	priv->catalog = NULL;
 	priv->dirs = NULL;
 	priv->apps = NULL;
-	priv->filtered_apps = NULL;
-	priv->grid_children = NULL;
-	priv->cur_apps = NULL;
+	priv->filtered_apps = g_ptr_array_new ();
+	priv->ranked_apps = 0;
+	priv->grid_children = g_ptr_array_new ();
+	priv->cur_apps = g_ptr_array_new ();
+	priv->cur_indices = g_array_new (FALSE, FALSE, sizeof (guint));
+	priv->seen_names = g_hash_table_new (entry_name_hash, entry_name_equal);
+	priv->cur_set = applauncher_bitset_new (0);
+	priv->cur_dir_pos = 0;
+	priv->search_cache = NULL;
+	priv->history = NULL;
+	priv->icon_cache = NULL;
+	priv->history_serial = 0;
+	priv->search = applauncher_search_session_new ();
+	priv->hangul_search = applauncher_search_session_new ();
+	priv->hangul_key = NULL;
+	priv->search_task = NULL;
+	priv->search_cancellable = NULL;
+	priv->search_delivered = 0;
+	priv->activate_pending = FALSE;
 	priv->selected_appitem = NULL;
 	priv->filter_text = NULL;
+	priv->filter_key = NULL;
 	priv->idle_entry_changed_id = 0;
 	priv->idle_directory_changed_id = 0;
 	priv->grid_x = DEFAULT_GRID_X;
 	priv->grid_y = DEFAULT_GRID_Y;
 	priv->icon_size = DEFAULT_ICON_SIZE;
+	priv->item_font = NULL;
+	priv->item_scale = 0;
+	priv->item_icon_size = 0;
+	priv->item_generation = 0;
+	priv->item_size = 0;
+	priv->probe_width = 0;
+	priv->probe_one_line_height = 0;
+	priv->probe_two_lines_height = 0;
+	priv->name_layout = NULL;
+	priv->layout_item_size = 0;
+	priv->layout_workarea_width = 0;
+	priv->layout_workarea_height = 0;
+	priv->layout_rows = -1;
+	priv->layout_cols = -1;
 	priv->grab_pointer = NULL;
 	priv->draging = FALSE;
 	priv->drag_copied = FALSE;
@@ -1561,13 +1999,6 @@ applauncher_window_init (ApplauncherWindow *window)
 		gtk_widget_set_visual (GTK_WIDGET(window), visual);
 	}
 
-	apply_blacklist ();
-
-	priv->dirs = get_all_directories ();
-	priv->apps = get_all_applications ();
-
-	populate_dirs (window);
-
 	priv->pages = applauncher_indicator_new ();
 	gtk_stack_add_named (GTK_STACK (priv->stk_bottom), GTK_WIDGET (priv->pages), "indicator");
 	/* 최초 윈도우 너비를 고려하여 1개만 삽입한다. */
@@ -1601,18 +2032,42 @@ applauncher_window_init (ApplauncherWindow *window)
 	gtk_widget_add_events (priv->event_box_appitem, GDK_SCROLL_MASK);
 }
 
+static void
+applauncher_window_destroy (GtkWidget *widget)
+{
+	ApplauncherWindow *window = APPLAUNCHER_WINDOW (widget);
+
+	/* 검색 스레드가 끝난 뒤 해제된 그리드를 건드리지 않도록 결과를 무시하게 한다. */
+	cancel_search (window);
+
+	/* 윈도우 객체는 작업이 참조를 놓을 때까지 남을 수 있으므로 카탈로그 변경도 더 받지 않는다. */
+	if (window->priv->catalog)
+		g_signal_handlers_disconnect_by_data (window->priv->catalog, window);
+
+	GTK_WIDGET_CLASS (applauncher_window_parent_class)->destroy (widget);
+}
+
 static void
 applauncher_window_finalize (GObject *object)
 {
 	ApplauncherWindow *window = APPLAUNCHER_WINDOW (object);
 	ApplauncherWindowPrivate *priv = window->priv;
 
-	g_slist_free_full (priv->dirs, (GDestroyNotify)gmenu_tree_item_unref);
-	g_slist_free_full (priv->apps, (GDestroyNotify)gmenu_tree_item_unref);
-	g_slist_free_full (priv->cur_apps, (GDestroyNotify)gmenu_tree_item_unref);
-	g_slist_free (priv->filtered_apps);
+	g_ptr_array_free (priv->cur_apps, TRUE);
+	g_array_unref (priv->cur_indices);
+	g_ptr_array_free (priv->filtered_apps, TRUE);
+	g_hash_table_destroy (priv->seen_names);
+	applauncher_bitset_free (priv->cur_set);
+	applauncher_search_session_free (priv->search);
+	applauncher_search_session_free (priv->hangul_search);
+	g_free (priv->hangul_key);
+
+	if (priv->catalog) {
+		g_signal_handlers_disconnect_by_func (priv->catalog, catalog_changed_cb, window);
+		g_clear_object (&priv->catalog);
+	}
 
-	g_list_free (priv->grid_children);
+	g_ptr_array_free (priv->grid_children, TRUE);
 
 	if (priv->idle_entry_changed_id != 0) {
 		g_source_remove (priv->idle_entry_changed_id);
@@ -1625,6 +2080,9 @@ applauncher_window_finalize (GObject *object)
 	}
 
 	g_clear_pointer (&priv->filter_text, g_free);
+	g_clear_pointer (&priv->filter_key, g_free);
+	g_clear_pointer (&priv->item_font, g_free);
+	g_clear_object (&priv->name_layout);
 
 	G_OBJECT_CLASS (applauncher_window_parent_class)->finalize (object);
 }
@@ -1636,6 +2094,7 @@ applauncher_window_class_init (ApplauncherWindowClass *klass)
 	GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (klass);
 
 	object_class->finalize = applauncher_window_finalize;
+	widget_class->destroy = applauncher_window_destroy;
 	widget_class->focus_out_event = applauncher_window_focus_out_event;
 	widget_class->realize = applauncher_window_realize;
 	widget_class->map_event = applauncher_window_map_event;
@@ -1664,6 +2123,15 @@ applauncher_window_class_init (ApplauncherWindowClass *klass)
                                             G_TYPE_NONE, 1,
                                             G_TYPE_STRING);
 
+	signals[RELOADED] = g_signal_new ("reloaded",
+                                      WINDOW_TYPE_APPLAUNCHER,
+                                      G_SIGNAL_RUN_LAST,
+                                      G_STRUCT_OFFSET(ApplauncherWindowClass,
+                                      reloaded),
+                                      NULL, NULL,
+                                      g_cclosure_marshal_VOID__VOID,
+                                      G_TYPE_NONE, 0);
+
 	gtk_widget_class_set_template_from_resource (GTK_WIDGET_CLASS (klass),
 			"/kr/gooroom/applauncher/ui/applauncher-window.ui");
 
@@ -1675,16 +2143,36 @@ applauncher_window_class_init (ApplauncherWindowClass *klass)
 }
 
 ApplauncherWindow *
-applauncher_window_new (GtkWidget *parent)
+applauncher_window_new (GtkWidget              *parent,
+                        ApplauncherCatalog     *catalog,
+                        ApplauncherSearchCache *search_cache,
+                        ApplauncherHistory     *history,
+                        ApplauncherIconCache   *icon_cache)
 {
+	ApplauncherWindow *window;
 	GtkWidget *toplevel = gtk_widget_get_toplevel (parent);
 
-	return g_object_new (WINDOW_TYPE_APPLAUNCHER,
-                         "type", GTK_WINDOW_TOPLEVEL,
-                         "type-hint", GDK_WINDOW_TYPE_HINT_POPUP_MENU,
-                         "transient-for", toplevel,
-                         "modal", TRUE,
-                         NULL);
+	g_return_val_if_fail (APPLAUNCHER_IS_CATALOG (catalog), NULL);
+
+	window = g_object_new (WINDOW_TYPE_APPLAUNCHER,
+                           "type", GTK_WINDOW_TOPLEVEL,
+                           "type-hint", GDK_WINDOW_TYPE_HINT_POPUP_MENU,
+                           "transient-for", toplevel,
+                           "modal", TRUE,
+                           NULL);
+
+	/* 카탈로그는 애플릿이 소유하며, 읽는 동안 윈도우는 빈 그리드로 먼저 표시한다. */
+	window->priv->catalog = g_object_ref (catalog);
+	window->priv->search_cache = search_cache;
+	window->priv->history = history;
+	window->priv->icon_cache = icon_cache;
+	g_signal_connect (G_OBJECT (catalog), "changed",
+                      G_CALLBACK (catalog_changed_cb), window);
+
+	if (applauncher_catalog_is_loaded (catalog))
+		catalog_changed_cb (catalog, TRUE, window);
+
+	return window;
 }
 
 void
@@ -1700,12 +2188,14 @@ applauncher_window_reload_apps (ApplauncherWindow *window,
 	applauncher_indicator_reset (priv->pages);
 
 	int p = 0;
-	int total_pages = get_total_pages (window, priv->apps);
+	int total_pages = get_total_pages (window, priv->apps ? priv->apps->len : 0);
 	for (p = 0; p < total_pages; p++) {
 		applauncher_indicator_append (priv->pages);
 	}
 
 	applauncher_window_select_all_programs (window);
+
+	g_signal_emit (G_OBJECT (window), signals[RELOADED], 0);
 }
 
 void
@@ -1716,8 +2206,76 @@ applauncher_window_set_workarea (ApplauncherWindow *window,
 
 	ApplauncherWindowPrivate *priv = window->priv;
 
+	if (gdk_rectangle_equal (&priv->workarea, workarea))
+		return;
+
 	priv->workarea.x = workarea->x;
 	priv->workarea.y = workarea->y;
 	priv->workarea.width = workarea->width;
 	priv->workarea.height = workarea->height;
+
+	/* 이미 생성된 윈도우는 작업 영역이 바뀐 경우에만 그리드를 다시 구성한다. */
+	if (gtk_widget_get_realized (GTK_WIDGET (window)))
+		applauncher_window_reload_apps (window, &priv->workarea);
+}
+
+void
+applauncher_window_reset (ApplauncherWindow *window)
+{
+	GList *children;
+	GtkWidget *first_dir;
+	gboolean filtered;
+
+	g_return_if_fail (WINDOW_IS_APPLAUNCHER (window));
+
+	ApplauncherWindowPrivate *priv = window->priv;
+
+	if (priv->idle_entry_changed_id != 0) {
+		g_source_remove (priv->idle_entry_changed_id);
+		priv->idle_entry_changed_id = 0;
+	}
+
+	if (priv->idle_directory_changed_id != 0) {
+		g_source_remove (priv->idle_directory_changed_id);
+		priv->idle_directory_changed_id = 0;
+	}
+
+	priv->selected_appitem = NULL;
+	priv->draging = FALSE;
+	priv->drag_copied = FALSE;
+
+	cancel_search (window);
+	priv->activate_pending = FALSE;
+
+	filtered = (priv->filter_text && !g_str_equal (priv->filter_text, ""));
+	g_clear_pointer (&priv->filter_text, g_free);
+	g_clear_pointer (&priv->filter_key, g_free);
+
+	if (gtk_entry_get_text_length (GTK_ENTRY (priv->ent_search)) > 0) {
+		g_signal_handlers_block_by_func (priv->ent_search, on_search_entry_changed_cb, window);
+		gtk_entry_reset_im_context (GTK_ENTRY (priv->ent_search));
+		gtk_entry_set_text (GTK_ENTRY (priv->ent_search), "");
+		g_signal_handlers_unblock_by_func (priv->ent_search, on_search_entry_changed_cb, window);
+	}
+
+	children = gtk_container_get_children (GTK_CONTAINER (priv->lbx_dirs));
+	first_dir = children ? GTK_WIDGET (children->data) : NULL;
+	g_list_free (children);
+
+	if (!first_dir)
+		return;
+
+	/* cur_dir_button 은 마우스가 올라간 항목일 수 있으므로 실제 선택 상태를 확인한다. */
+	priv->cur_dir_button = first_dir;
+
+	if (!gtk_toggle_button_get_active (GTK_TOGGLE_BUTTON (first_dir))) {
+		/* toggled 핸들러에서 목록과 페이지가 다시 구성된다. */
+		gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (first_dir), TRUE);
+	} else if (filtered ||
+	           (priv->history && applauncher_history_get_serial (priv->history) != priv->history_serial)) {
+		/* 실행 기록이 바뀌었으면 첫 줄의 자주 쓰는 항목도 다시 구한다. */
+		applauncher_window_select_all_programs (window);
+	} else if (applauncher_indicator_get_active (priv->pages) != 0) {
+		applauncher_indicator_set_active (priv->pages, 0);
+	}
 }
@@ -21,6 +21,11 @@
 
 #include <gtk/gtk.h>
 
+#include "applauncher-catalog.h"
+#include "applauncher-search-cache.h"
+#include "applauncher-history.h"
+#include "applauncher-icon-cache.h"
+
 G_BEGIN_DECLS
 
 #define WINDOW_TYPE_APPLAUNCHER            (applauncher_window_get_type ())
@@ -47,6 +52,8 @@ struct _ApplauncherWindowClass
 	void (*closed)(ApplauncherWindow *window, gint reason);
 
 	void (*launch_desktop)(ApplauncherWindow *window, const gchar *desktop);
+
+	void (*reloaded)(ApplauncherWindow *window);
 };
 
 struct _ApplauncherWindow
@@ -59,7 +66,11 @@ struct _ApplauncherWindow
 
 GType              applauncher_window_get_type (void) G_GNUC_CONST;
 
-ApplauncherWindow *applauncher_window_new             (GtkWidget *parent);
+ApplauncherWindow *applauncher_window_new             (GtkWidget              *parent,
+                                                       ApplauncherCatalog     *catalog,
+                                                       ApplauncherSearchCache *search_cache,
+                                                       ApplauncherHistory     *history,
+                                                       ApplauncherIconCache   *icon_cache);
 
 void               applauncher_window_reload_apps     (ApplauncherWindow *window,
                                                        GdkRectangle      *workarea);
@@ -67,6 +78,8 @@ void               applauncher_window_reload_apps     (ApplauncherWindow *window
 void               applauncher_window_set_workarea    (ApplauncherWindow *window,
                                                        GdkRectangle      *workarea);
 
+void               applauncher_window_reset           (ApplauncherWindow *window);
+
 
 G_END_DECLS
 